@@ -0,0 +1,69 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include <cstddef> // Include for std::size_t
+
+namespace operators {
+
+/**
+ * Thread-local, size-class pool that recycles freed SquareMat buffers.
+ *
+ * Requests are rounded up to a size class (quarter steps between powers of two,
+ * so at most 25% is wasted) and freed buffers are kept on a per-thread free list
+ * for their class instead of going back to the system allocator. The bytes a
+ * thread keeps cached are bounded by capacity(); anything beyond that is freed
+ * right away. A buffer may be released on a different thread than the one that
+ * acquired it.
+ *
+ * Building with -DMATRIX_NO_POOL turns acquire/release into plain aligned
+ * new/delete, so tools like Valgrind see every allocation (see `make valgrind`).
+ */
+class BufferPool {
+public:
+    // Alignment in bytes of every buffer handed out
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    // Default cap on the bytes each thread keeps cached
+    static constexpr std::size_t DEFAULT_CAPACITY = std::size_t(64) << 20;
+
+    /**
+     * Gets an ALIGNMENT aligned buffer, reusing a cached one of the same class when possible
+     * @param bytes Number of bytes requested
+     * @return Pointer to uninitialized memory
+     * @throws std::bad_alloc if the system allocator fails
+     */
+    static void* acquire(std::size_t bytes);
+
+    /**
+     * Returns a buffer to the calling thread's pool (or to the system if the pool is full)
+     * @param ptr Pointer previously returned by acquire, may be nullptr
+     * @param bytes The size passed to acquire
+     */
+    static void release(void* ptr, std::size_t bytes);
+
+    /**
+     * Sets the cap on cached bytes per thread. Threads above the new cap trim
+     * themselves on their next release.
+     * @param bytes New cap; 0 disables caching
+     */
+    static void setCapacity(std::size_t bytes);
+
+    /**
+     * @return The cap on cached bytes per thread
+     */
+    static std::size_t capacity();
+
+    /**
+     * @return Bytes currently cached by the calling thread
+     */
+    static std::size_t cachedBytes();
+
+    /**
+     * Frees cached buffers of the calling thread, largest classes first
+     * @param targetBytes Stop once at most this many bytes remain cached
+     */
+    static void trim(std::size_t targetBytes = 0);
+};
+
+}
@@ -0,0 +1,41 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include <cstdint>  // Include for std::int64_t
+#include <complex>  // Include for std::complex
+
+namespace operators {
+
+// Element operations that differ between the supported element types
+template <typename T>
+struct ElementTraits {
+    // Floating-point elements are truncated to int before taking the modulo
+    static T modulo(T value, int scalar) { return static_cast<int>(value) % scalar; }
+
+    // Ordering used by the comparison operators
+    static bool less(const T& a, const T& b) { return a < b; }
+};
+
+template <>
+struct ElementTraits<std::int64_t> {
+    // Integers take the modulo directly, without narrowing to int
+    static std::int64_t modulo(std::int64_t value, int scalar) { return value % scalar; }
+
+    static bool less(std::int64_t a, std::int64_t b) { return a < b; }
+};
+
+template <>
+struct ElementTraits<std::complex<double>> {
+    using Complex = std::complex<double>;
+
+    // Real and imaginary parts are reduced separately
+    static Complex modulo(const Complex& value, int scalar) {
+        return Complex(static_cast<int>(value.real()) % scalar, static_cast<int>(value.imag()) % scalar);
+    }
+
+    // Complex numbers have no natural order, so compare magnitudes
+    static bool less(const Complex& a, const Complex& b) { return std::abs(a) < std::abs(b); }
+};
+
+}
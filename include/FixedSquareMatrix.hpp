@@ -0,0 +1,498 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include "SquareMatrix.hpp"
+#include "ElementTraits.hpp"
+#include "Lu.hpp"
+#include <iostream>  // Include for std::ostream and std::endl
+#include <stdexcept> // Include for std::invalid_argument and std::out_of_range
+#include <type_traits> // Include for std::is_integral
+
+namespace operators {
+
+/**
+ * Square matrix whose dimension N is known at compile time.
+ *
+ * Elements live inside the object (no heap, no arena, no pool), and every loop
+ * has a constant trip count, so the compiler fully unrolls and vectorizes the
+ * kernels for the usual 2x2, 3x3 and 4x4 cases. The operator set matches
+ * BasicSquareMat, and the two convert into each other:
+ *
+ *     FixedSquareMat<3> rotation(someSquareMat); // checks the size once
+ *     SquareMat dynamic = rotation * rotation;   // implicit conversion back
+ */
+template <int N, typename T = double>
+class FixedSquareMat {
+    static_assert(N > 0, "Matrix size must be positive");
+
+private:
+    T data[N][N]; // Row-major elements
+
+    // base^power for power >= 1, squaring from the lowest set bit instead of the identity
+    static FixedSquareMat raise(FixedSquareMat base, long long power) {
+        while (power % 2 == 0) {
+            base = base * base;
+            power /= 2;
+        }
+        FixedSquareMat result(base);
+        while (power /= 2) {
+            base = base * base;
+            if (power % 2 == 1)
+                result = result * base;
+        }
+        return result;
+    }
+
+public:
+    // Element type of the matrix
+    using value_type = T;
+
+    // Number of rows = columns
+    static constexpr int SIZE = N;
+
+    // --- Constructors and conversions ---
+
+    /**
+     * Constructs a matrix with all elements initialized to zero
+     */
+    FixedSquareMat() : data() {}
+
+    /**
+     * Copies a dynamically sized matrix of the same dimension
+     * @param other Matrix to copy
+     * @throws std::invalid_argument if other is not N x N
+     */
+    explicit FixedSquareMat(const BasicSquareMat<T>& other) {
+        if (other.getSize() != N)
+            throw std::invalid_argument("Matrices must be of the same size");
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] = other(i, j);
+    }
+
+    /**
+     * Converts to a dynamically sized matrix (stored inline when N <= SMALL_SIZE)
+     * @return New BasicSquareMat with the same elements
+     */
+    operator BasicSquareMat<T>() const {
+        BasicSquareMat<T> result = BasicSquareMat<T>::uninitialized(N);
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                result(i, j) = data[i][j];
+        return result;
+    }
+
+    /**
+     * @return The identity matrix
+     */
+    static FixedSquareMat identity() {
+        FixedSquareMat result;
+        for (int i = 0; i < N; ++i)
+            result.data[i][i] = T(1);
+        return result;
+    }
+
+    /**
+     * @return The number of rows (= columns) of the matrix
+     */
+    static constexpr int getSize() { return N; }
+
+    // --- Arithmetic operators ---
+
+    /**
+     * Adds this matrix with another matrix element-by-element
+     * @param other Matrix to add
+     * @return New matrix containing the sum
+     */
+    FixedSquareMat operator+(const FixedSquareMat& other) const {
+        FixedSquareMat result(*this);
+        return result += other;
+    }
+
+    /**
+     * Subtracts another matrix from this matrix element-by-element
+     * @param other Matrix to subtract
+     * @return New matrix containing the difference
+     */
+    FixedSquareMat operator-(const FixedSquareMat& other) const {
+        FixedSquareMat result(*this);
+        return result -= other;
+    }
+
+    /**
+     * Negates all elements in the matrix
+     * @return New matrix with negated elements
+     */
+    FixedSquareMat operator-() const {
+        FixedSquareMat result;
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                result.data[i][j] = -data[i][j];
+        return result;
+    }
+
+    /**
+     * Multiplies this matrix with another matrix; the loops are fully unrolled
+     * @param other Matrix to multiply with
+     * @return New matrix containing the product
+     */
+    FixedSquareMat operator*(const FixedSquareMat& other) const {
+        FixedSquareMat result;
+#pragma GCC unroll 16
+        for (int i = 0; i < N; ++i) {
+#pragma GCC unroll 16
+            for (int k = 0; k < N; ++k) {
+                const T a = data[i][k];
+#pragma GCC unroll 16
+                for (int j = 0; j < N; ++j)
+                    result.data[i][j] += a * other.data[k][j];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Multiplies each element in the matrix by a scalar
+     * @param scalar The value to multiply by
+     * @return New matrix with scaled elements
+     */
+    FixedSquareMat operator*(T scalar) const {
+        FixedSquareMat result;
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                result.data[i][j] = data[i][j] * scalar;
+        return result;
+    }
+
+    /**
+     * Element-wise multiplication of two matrices
+     * @param other Matrix to multiply with element-by-element
+     * @return New matrix with each element being the product of corresponding elements
+     */
+    FixedSquareMat operator%(const FixedSquareMat& other) const {
+        FixedSquareMat result(*this);
+        return result %= other;
+    }
+
+    /**
+     * Applies modulo operation to each element in the matrix
+     * @param scalar The modulo value (integer)
+     * @return New matrix with modulo applied to each element
+     * @throws std::invalid_argument if scalar is zero
+     */
+    FixedSquareMat operator%(int scalar) const {
+        FixedSquareMat result(*this);
+        return result %= scalar;
+    }
+
+    /**
+     * Divides each element in the matrix by a scalar
+     * @param scalar The value to divide by
+     * @return New matrix with divided elements
+     * @throws std::invalid_argument if scalar is zero
+     */
+    FixedSquareMat operator/(T scalar) const {
+        FixedSquareMat result(*this);
+        return result /= scalar;
+    }
+
+    /**
+     * Raises the matrix to a power by repeated squaring, without multiplying by the identity.
+     * A negative power -k raises inverse() to k, as for BasicSquareMat.
+     * @param power The exponent
+     * @return New matrix representing this matrix raised to the power
+     * @throws std::invalid_argument if power is negative and the matrix is singular or has integer elements
+     */
+    FixedSquareMat operator^(int power) const {
+        if (power < 0)
+            return raise(inverse(), -static_cast<long long>(power));
+        if (power == 0)
+            return identity();
+        return raise(*this, power);
+    }
+
+    /**
+     * Inverse from an LU factorization with partial pivoting (see Lu.hpp), computed inside the object
+     * @return New matrix X with this * X = I
+     * @throws std::invalid_argument if the matrix is singular or has integer elements
+     */
+    FixedSquareMat inverse() const {
+        if constexpr (std::is_integral<T>::value) {
+            throw std::invalid_argument("Integer matrices cannot be inverted");
+        } else {
+            FixedSquareMat lu(*this);
+            FixedSquareMat result = identity();
+            int pivots[N];
+            if (!kernels::luFactor(N, &lu.data[0][0], N, pivots))
+                throw std::invalid_argument("Matrix is singular");
+            kernels::luSolve(N, &lu.data[0][0], N, pivots, N, &result.data[0][0], N);
+            return result;
+        }
+    }
+
+    // --- Increment and decrement operators ---
+
+    /**
+     * Pre-increment operator: adds 1 to all elements
+     * @return Reference to this matrix after incrementing
+     */
+    FixedSquareMat& operator++() {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] += T(1);
+        return *this;
+    }
+
+    /**
+     * Post-increment operator: adds 1 to all elements
+     * @return Copy of the matrix before incrementing
+     */
+    FixedSquareMat operator++(int) {
+        FixedSquareMat temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    /**
+     * Pre-decrement operator: subtracts 1 from all elements
+     * @return Reference to this matrix after decrementing
+     */
+    FixedSquareMat& operator--() {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] -= T(1);
+        return *this;
+    }
+
+    /**
+     * Post-decrement operator: subtracts 1 from all elements
+     * @return Copy of the matrix before decrementing
+     */
+    FixedSquareMat operator--(int) {
+        FixedSquareMat temp(*this);
+        --(*this);
+        return temp;
+    }
+
+    /**
+     * Transposes the matrix; the loops are fully unrolled
+     * @return New transposed matrix
+     */
+    FixedSquareMat operator~() const {
+        FixedSquareMat result;
+#pragma GCC unroll 16
+        for (int i = 0; i < N; ++i)
+#pragma GCC unroll 16
+            for (int j = 0; j < N; ++j)
+                result.data[i][j] = data[j][i];
+        return result;
+    }
+
+    // --- Access ---
+
+    /**
+     * Accessor for matrix rows that allows writing elements
+     * @param index The row index
+     * @return Pointer to the row's data
+     * @throws std::out_of_range if index is invalid
+     */
+    T* operator[](int index) {
+        if (index < 0 || index >= N)
+            throw std::out_of_range("Index out of bounds");
+        return data[index];
+    }
+
+    /**
+     * Const accessor for matrix rows that allows reading elements
+     * @param index The row index
+     * @return Const pointer to the row's data
+     * @throws std::out_of_range if index is invalid
+     */
+    const T* operator[](int index) const {
+        if (index < 0 || index >= N)
+            throw std::out_of_range("Index out of bounds");
+        return data[index];
+    }
+
+    /**
+     * Unchecked element access
+     * @param i The row index (0 <= i < N)
+     * @param j The column index (0 <= j < N)
+     * @return Reference to the element
+     */
+    T& operator()(int i, int j) { return data[i][j]; }
+    const T& operator()(int i, int j) const { return data[i][j]; }
+
+    /**
+     * Bounds-checked element access
+     * @param i The row index
+     * @param j The column index
+     * @return Reference to the element
+     * @throws std::out_of_range if either index is invalid
+     */
+    T& at(int i, int j) {
+        if (i < 0 || i >= N || j < 0 || j >= N)
+            throw std::out_of_range("Index out of bounds");
+        return data[i][j];
+    }
+
+    const T& at(int i, int j) const {
+        if (i < 0 || i >= N || j < 0 || j >= N)
+            throw std::out_of_range("Index out of bounds");
+        return data[i][j];
+    }
+
+    // --- Comparison operators (based on the sum of elements, like BasicSquareMat) ---
+
+    bool operator==(const FixedSquareMat& other) const { return sumElements(*this) == sumElements(other); }
+    bool operator!=(const FixedSquareMat& other) const { return !(*this == other); }
+    bool operator<(const FixedSquareMat& other) const {
+        return ElementTraits<T>::less(sumElements(*this), sumElements(other));
+    }
+    bool operator>(const FixedSquareMat& other) const { return other < *this; }
+    bool operator<=(const FixedSquareMat& other) const { return !(*this > other); }
+    bool operator>=(const FixedSquareMat& other) const { return !(*this < other); }
+
+    /**
+     * Determinant operator: closed forms up to 3x3, unrolled cofactor expansion up to 4x4,
+     * fraction-free (Bareiss) elimination above that, which stays exact for integers
+     * @return The determinant value
+     */
+    T operator!() const {
+        if constexpr (N == 1) {
+            return data[0][0];
+        } else if constexpr (N == 2) {
+            return data[0][0] * data[1][1] - data[0][1] * data[1][0];
+        } else if constexpr (N == 3) {
+            return data[0][0] * (data[1][1] * data[2][2] - data[1][2] * data[2][1])
+                 - data[0][1] * (data[1][0] * data[2][2] - data[1][2] * data[2][0])
+                 + data[0][2] * (data[1][0] * data[2][1] - data[1][1] * data[2][0]);
+        } else if constexpr (N == 4) {
+            T det = T(0);
+            for (int x = 0; x < N; ++x) {
+                FixedSquareMat<N - 1, T> minor;
+                for (int i = 1; i < N; ++i)
+                    for (int j = 0, subj = 0; j < N; ++j)
+                        if (j != x)
+                            minor(i - 1, subj++) = data[i][j];
+                const T sign = x % 2 == 0 ? T(1) : T(-1);
+                det += sign * data[0][x] * !minor;
+            }
+            return det;
+        } else {
+            return bareiss();
+        }
+    }
+
+    // --- Compound assignment operators ---
+
+    FixedSquareMat& operator+=(const FixedSquareMat& other) {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] += other.data[i][j];
+        return *this;
+    }
+
+    FixedSquareMat& operator-=(const FixedSquareMat& other) {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] -= other.data[i][j];
+        return *this;
+    }
+
+    FixedSquareMat& operator*=(const FixedSquareMat& other) {
+        return *this = *this * other; // Stack temporary, no allocation
+    }
+
+    FixedSquareMat& operator/=(T scalar) {
+        if (scalar == T(0))
+            throw std::invalid_argument("Division by zero");
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] /= scalar;
+        return *this;
+    }
+
+    FixedSquareMat& operator%=(int scalar) {
+        if (scalar == 0)
+            throw std::invalid_argument("Modulo by zero");
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] = ElementTraits<T>::modulo(data[i][j], scalar);
+        return *this;
+    }
+
+    FixedSquareMat& operator%=(const FixedSquareMat& other) {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                data[i][j] *= other.data[i][j];
+        return *this;
+    }
+
+    // --- Friend functions ---
+
+    /**
+     * Calculates the sum of all elements in the matrix
+     * @param mat Matrix whose elements to sum
+     * @return Sum of all elements
+     */
+    friend T sumElements(const FixedSquareMat& mat) {
+        T total = T(0);
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                total += mat.data[i][j];
+        return total;
+    }
+
+    // Scalar multiplication from left side
+    friend FixedSquareMat operator*(T scalar, const FixedSquareMat& mat) { return mat * scalar; }
+
+    /**
+     * Output operator - prints the matrix in the same format as BasicSquareMat
+     * @param os Output stream
+     * @param mat Matrix to output
+     * @return Reference to the output stream
+     */
+    friend std::ostream& operator<<(std::ostream& os, const FixedSquareMat& mat) {
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j)
+                os << mat.data[i][j] << " ";
+            os << std::endl;
+        }
+        return os;
+    }
+
+private:
+    // Fraction-free Gaussian elimination; every division is exact
+    T bareiss() const {
+        T m[N][N];
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                m[i][j] = data[i][j];
+        T sign = T(1);
+        T previous = T(1);
+        for (int k = 0; k < N - 1; ++k) {
+            if (m[k][k] == T(0)) { // Swap in a row with a non-zero pivot
+                int p = k + 1;
+                while (p < N && m[p][k] == T(0))
+                    ++p;
+                if (p == N)
+                    return T(0);
+                for (int j = 0; j < N; ++j) {
+                    const T tmp = m[k][j];
+                    m[k][j] = m[p][j];
+                    m[p][j] = tmp;
+                }
+                sign = -sign;
+            }
+            for (int i = k + 1; i < N; ++i)
+                for (int j = k + 1; j < N; ++j)
+                    m[i][j] = (m[i][j] * m[k][k] - m[i][k] * m[k][j]) / previous;
+            previous = m[k][k];
+        }
+        return sign * m[N - 1][N - 1];
+    }
+};
+
+}
@@ -0,0 +1,140 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include <cstdint> // Include for std::int64_t
+
+namespace operators {
+namespace kernels {
+
+/**
+ * Cache blocking parameters of the matrix product, in elements.
+ * kc x nc panels of B are packed to stay in L3 (nc) and be streamed from L2 (kc),
+ * mc x kc panels of A are packed to stay in L2 while the micro-kernel runs from L1.
+ */
+struct GemmBlocking {
+    int mc; // Rows of A per packed panel
+    int kc; // Depth (columns of A / rows of B) per packed panel
+    int nc; // Columns of B per packed panel
+};
+
+/**
+ * @return The blocking used for elements of type T with the active instruction set
+ */
+template <typename T>
+GemmBlocking gemmBlocking();
+
+/**
+ * Overrides the blocking used for elements of type T with the active instruction set.
+ * mc and nc are rounded down to the micro-tile of the kernel; a zero field keeps the built-in size.
+ * @param blocking The new blocking; {0, 0, 0} restores the built-in sizes
+ */
+template <typename T>
+void setGemmBlocking(GemmBlocking blocking);
+
+/**
+ * Reads a tuning profile, as written by saveTuningProfile (see `make tune`): one
+ * "isa type mc kc nc" line per instruction set and element type, e.g. "avx2 double 96 256 4096",
+ * with type one of float, double, int64 or complex. Lines it does not recognize are skipped.
+ * The first product loads the file named by MATRIX_TUNING, or gemm.tuning in the working
+ * directory; without one the built-in sizes are used.
+ * @param path The profile to read
+ * @return false (and nothing changes) if the file cannot be opened
+ */
+bool loadTuningProfile(const char* path);
+
+/**
+ * Writes every overridden blocking, for all instruction sets, as a tuning profile
+ * @param path The profile to write
+ * @return false if the file cannot be written
+ */
+bool saveTuningProfile(const char* path);
+
+/**
+ * Whether an operand of gemm is used as stored or transposed
+ */
+enum class Transpose { No, Yes };
+
+/**
+ * General matrix product on raw row-major storage: C = alpha * op(A) * op(B) + beta * C,
+ * all three n x n with leading dimensions lda, ldb and ldc, where op(X) is X or its
+ * transpose. Transposed operands are read in transposed order while packing, so no
+ * transposed copy is made.
+ * Products below a small size run a direct loop; larger ones use a cache-blocked
+ * kernel that packs A and B into contiguous panels for the micro-kernel of the
+ * active instruction set (see SimdKernels.hpp).
+ * Float, double and complex products of at least strassenCrossover() use Strassen-Winograd
+ * recursion down to the blocked kernel.
+ * When beta is zero C is never read, so it may be uninitialized. C must not alias A or B.
+ */
+template <typename T>
+void gemm(Transpose transA, Transpose transB, int n, T alpha, const T* a, int lda, const T* b, int ldb, T beta,
+          T* c, int ldc);
+
+/**
+ * C = alpha * A * B + beta * C, see above
+ */
+template <typename T>
+void gemm(int n, T alpha, const T* a, int lda, const T* b, int ldb, T beta, T* c, int ldc) {
+    gemm(Transpose::No, Transpose::No, n, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+/**
+ * Mixed-precision product on raw row-major storage: C = A * B with A and B rounded to float
+ * and multiplied by the float micro-kernels (twice the SIMD lanes, half the bandwidth),
+ * while slices of MIXED_DEPTH terms are accumulated into the double C. The relative error
+ * is around 1e-6 instead of 1e-15. Large products are tiled across the thread pool.
+ * C is never read, so it may be uninitialized. C must not alias A or B.
+ */
+void gemmMixed(int n, const double* a, int lda, const double* b, int ldb, double* c, int ldc);
+
+// Depth of the float partial products gemmMixed adds into double
+constexpr int MIXED_DEPTH = 256;
+
+/**
+ * Modular product on raw row-major storage: C = A * B mod m, for A and B with elements in
+ * [0, m) and 0 < m < 2^63. Products accumulate in 64 bits when m <= 2^31 and in 128 bits
+ * otherwise, taking m^2 off the sum whenever it reaches it, so each element of C costs one
+ * division instead of one per term. Rows of large products are spread over the thread pool.
+ * C must not alias A or B.
+ */
+void gemmMod(int n, const std::int64_t* a, int lda, const std::int64_t* b, int ldb, std::int64_t* c, int ldc,
+             std::int64_t modulus);
+
+/**
+ * Which triangle of a symmetric result is computed
+ */
+enum class Triangle { Lower, Upper };
+
+/**
+ * Symmetric rank-k update on raw row-major storage: C = alpha * A * A^T + beta * C,
+ * computing and writing only the chosen triangle of C (diagonal included), so about
+ * half the work of the full product. Square tiles of that triangle are run through
+ * the blocked kernel, across the thread pool for large n.
+ * When beta is zero the triangle is never read. C must not alias A.
+ */
+template <typename T>
+void syrk(Triangle uplo, int n, T alpha, const T* a, int lda, T beta, T* c, int ldc);
+
+/**
+ * Sets the size from which floating-point products switch to Strassen-Winograd.
+ * Each level trades one of eight half-size products for 15 half-size additions, so it
+ * only pays off for large n, and it rounds differently from the classical algorithm.
+ * The default comes from the MATRIX_STRASSEN environment variable when set.
+ * @param n Crossover size; 0 turns Strassen off for results bitwise identical to the classical product
+ */
+void setStrassenCrossover(int n);
+
+/**
+ * Restores the default crossover: MATRIX_STRASSEN, read again, or 2048 when it is not set.
+ * Zero and negative values of the variable turn Strassen off.
+ */
+void resetStrassenCrossover();
+
+/**
+ * @return The current Strassen-Winograd crossover, 0 when it is off
+ */
+int strassenCrossover();
+
+}
+}
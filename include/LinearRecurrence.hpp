@@ -0,0 +1,60 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include "SquareMatrix.hpp"
+#include <cstdint> // Include for std::int64_t
+#include <vector>  // Include for std::vector
+
+namespace operators {
+
+/**
+ * n-th term of the linear recurrence a(n) = c[0] a(n-1) + c[1] a(n-2) + ... + c[k-1] a(n-k)
+ * by Kitamasa's method: x^n is reduced modulo the characteristic polynomial by repeated
+ * squaring, O(k^2 log n) instead of the O(k^3 log n) of raising the companion matrix.
+ * @param coefficients c[0], ..., c[k-1]
+ * @param initial a(0), ..., a(k-1)
+ * @param n Index of the term (non-negative)
+ * @return a(n)
+ * @throws std::invalid_argument if coefficients is empty, initial has a different length or n is negative
+ */
+template <typename T>
+T recurrenceTerm(const std::vector<T>& coefficients, const std::vector<T>& initial, std::int64_t n);
+
+/**
+ * recurrenceTerm with every operation reduced modulo modulus, for huge n (see powMod)
+ * @param modulus The modulus (positive, up to 2^63 - 1)
+ * @return a(n) mod modulus, in [0, modulus)
+ * @throws std::invalid_argument as recurrenceTerm, or if modulus is not positive
+ */
+std::int64_t recurrenceTermMod(const std::vector<std::int64_t>& coefficients, const std::vector<std::int64_t>& initial,
+                               std::int64_t n, std::int64_t modulus);
+
+/**
+ * Recognizes the companion matrix of a recurrence: coefficients in the first row, ones on the
+ * subdiagonal and zeros everywhere else, the matrix that steps (a(n+k-1), ..., a(n)) to
+ * (a(n+k), ..., a(n+1))
+ * @param a The matrix to inspect
+ * @param coefficients Receives the first row when a is a companion matrix
+ * @return true if a is in companion form
+ */
+template <typename T>
+bool companionCoefficients(const BasicSquareMat<T>& a, std::vector<T>& coefficients);
+
+/**
+ * Element (i, j) of a^power. Companion matrices take the O(k^2 log power) recurrence path,
+ * anything else is raised by operator^.
+ * @throws std::invalid_argument if power is negative
+ * @throws std::out_of_range if i or j is out of range
+ */
+template <typename T>
+T powerElement(const BasicSquareMat<T>& a, int power, int i, int j);
+
+/**
+ * Element (i, j) of powMod(a, power, modulus), through the recurrence path for companion matrices
+ * @throws std::invalid_argument if power is negative or modulus is not positive
+ * @throws std::out_of_range if i or j is out of range
+ */
+std::int64_t powModElement(const IntSquareMat& a, std::int64_t power, std::int64_t modulus, int i, int j);
+
+}
@@ -0,0 +1,26 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+namespace operators {
+namespace kernels {
+
+/**
+ * LU factorization with partial pivoting on raw row-major storage, in place: afterwards the
+ * strict lower triangle of A holds L (whose unit diagonal is implied) and the upper triangle
+ * holds U, with P * A = L * U where step k swapped row k with row pivots[k].
+ * @return false as soon as a pivot of at most n * epsilon * max|A| shows that A is singular to
+ *         working precision (A is then only partly factored)
+ */
+template <typename T>
+bool luFactor(int n, T* a, int lda, int* pivots);
+
+/**
+ * Solves A * X = B in place from the output of luFactor, where B is n x nrhs with leading
+ * dimension ldb and is overwritten by X
+ */
+template <typename T>
+void luSolve(int n, const T* lu, int ldlu, const int* pivots, int nrhs, T* b, int ldb);
+
+}
+}
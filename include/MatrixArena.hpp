@@ -0,0 +1,93 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include <cstddef> // Include for std::size_t
+#include <memory_resource> // Include for std::pmr::memory_resource
+
+namespace operators {
+
+/**
+ * Scoped bump-pointer arena for SquareMat storage.
+ * It is a std::pmr::memory_resource, so it can also be passed to a matrix explicitly.
+ *
+ * While a MatrixArena object is alive, every SquareMat constructed on the same
+ * thread takes its buffer from the arena instead of the global heap, and the
+ * whole arena is released at once when the scope ends:
+ *
+ *     SquareMat keep(n);
+ *     {
+ *         MatrixArena scope;
+ *         keep = (A + B) * (C - D) ^ 3; // temporaries never touch the heap
+ *     }
+ *
+ * Matrices created inside the scope must not outlive it. Assigning them to a
+ * matrix created outside the scope (as above) copies the elements, so that is
+ * the way to keep a result. Scopes nest; the innermost one is used. An arena
+ * belongs to the thread that created it and must be destroyed on that thread.
+ */
+class MatrixArena : public std::pmr::memory_resource {
+public:
+    // Alignment in bytes of every allocation handed out by the arena
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    // Default size in bytes of the blocks the arena carves allocations from
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    /**
+     * Opens an arena scope on the calling thread
+     * @param blockSize Size in bytes of each block requested from the heap
+     */
+    explicit MatrixArena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    /**
+     * Closes the scope and returns every block to the heap
+     */
+    ~MatrixArena();
+
+    MatrixArena(const MatrixArena&) = delete;
+    MatrixArena& operator=(const MatrixArena&) = delete;
+
+    /**
+     * @return Total bytes of heap blocks currently held by the arena
+     */
+    std::size_t reservedBytes() const { return reserved; }
+
+    /**
+     * @return The innermost arena open on the calling thread, or nullptr
+     */
+    static MatrixArena* current();
+
+private:
+    struct Block; // Header placed at the start of every heap block
+
+    /**
+     * Bump-allocates memory from the arena, valid until the arena is destroyed
+     * @throws std::bad_alloc if alignment exceeds ALIGNMENT
+     */
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    /**
+     * Gives memory back to the arena. Only the most recent allocation is actually
+     * reclaimed (the bump pointer moves back); anything else waits for the scope end.
+     */
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+
+    // Arenas are only interchangeable with themselves
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    // Requests a new heap block with room for at least bytes of payload
+    Block* newBlock(std::size_t bytes);
+
+    // Returns a chain of blocks to the heap
+    static void freeBlocks(Block* block);
+
+    std::size_t blockSize; // Payload size of regular blocks
+    Block* head;           // Block currently being bumped into
+    Block* oversized;      // Dedicated blocks for requests larger than half a block
+    std::size_t used;      // Bytes handed out from head
+    std::size_t reserved;  // Bytes of all blocks
+    MatrixArena* previous; // Enclosing scope on this thread
+};
+
+}
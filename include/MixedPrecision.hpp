@@ -0,0 +1,101 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include "SquareMatrix.hpp"
+
+namespace operators {
+
+/**
+ * Scoped opt-in to mixed-precision products.
+ *
+ * While a MixedPrecisionScope object is alive, every SquareMat::operator* on the same thread
+ * (and so operator^) multiplies in float32 and accumulates into double (see kernels::gemmMixed),
+ * and the residual of every such product is recorded in the scope:
+ *
+ *     {
+ *         MixedPrecisionScope mixed;
+ *         SquareMat c = a * b;
+ *         if (mixed.worstResidual() > 1e-5) ...
+ *     }
+ *
+ * Other element types, gemm() and operator*= are unaffected. Scopes nest; the innermost
+ * one is used. A scope belongs to the thread that created it.
+ */
+class MixedPrecisionScope {
+public:
+    /**
+     * Opens a mixed-precision scope on the calling thread
+     */
+    MixedPrecisionScope();
+
+    /**
+     * Closes the scope
+     */
+    ~MixedPrecisionScope();
+
+    MixedPrecisionScope(const MixedPrecisionScope&) = delete;
+    MixedPrecisionScope& operator=(const MixedPrecisionScope&) = delete;
+
+    /**
+     * @return Number of products computed in mixed precision within the scope
+     */
+    int products() const { return count; }
+
+    /**
+     * @return Residual (see productResidual) of the latest product, 0 before the first one
+     */
+    double lastResidual() const { return last; }
+
+    /**
+     * @return Largest residual of any product in the scope, 0 before the first one
+     */
+    double worstResidual() const { return worst; }
+
+    /**
+     * Adds the residual of a product to the scope; called by the mixed products
+     * @param residual The residual of the product
+     */
+    void record(double residual);
+
+    /**
+     * @return The innermost scope open on the calling thread, or nullptr
+     */
+    static MixedPrecisionScope* current();
+
+private:
+    int count;                     // Products recorded
+    double last;                   // Residual of the latest product
+    double worst;                  // Largest residual recorded
+    MixedPrecisionScope* previous; // Enclosing scope on this thread
+};
+
+/**
+ * Relative residual of a product C ~ A * B, checked in O(n^2) against a fixed pseudo-random
+ * vector x: max_i |A(Bx) - Cx|_i / (|A| |B| |x|)_i. It is about 1e-16 for a double product
+ * and about 1e-7 for a mixed-precision one.
+ * @throws std::invalid_argument if the sizes differ
+ */
+double productResidual(const SquareMat& a, const SquareMat& b, const SquareMat& c);
+
+/**
+ * A * B with float32 multiplication accumulated into double (see kernels::gemmMixed)
+ * @param residual If not null, receives productResidual of the result
+ * @return New matrix containing the product
+ * @throws std::invalid_argument if the sizes differ
+ */
+SquareMat multiplyMixed(const SquareMat& a, const SquareMat& b, double* residual = nullptr);
+
+/**
+ * Solves A * X = B in mixed precision: A is factored once in float32, then each round of
+ * iterative refinement computes the residual B - A * X in double and corrects X through the
+ * float factors, until X is accurate to double precision. If refinement stalls (A too badly
+ * conditioned for float) the system is solved again with a double factorization.
+ * @param residual If not null, receives the normwise backward error
+ *        ||B - A X|| / (||A|| ||X|| + ||B||) in the infinity norm
+ * @return New matrix X
+ * @throws std::invalid_argument if the sizes differ or A is singular
+ */
+SquareMat solveMixed(const SquareMat& a, const SquareMat& b, double* residual = nullptr);
+
+}
@@ -0,0 +1,187 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+// x86 builds carry SSE2, AVX2 and AVX-512 kernels, picked at run time
+#if defined(__x86_64__) || defined(__i386__)
+#define OPERATORS_X86_KERNELS 1
+#endif
+
+namespace operators {
+namespace kernels {
+
+/**
+ * Instruction sets with dedicated kernels, from slowest to fastest.
+ * The best one the CPU supports is chosen from CPUID the first time a kernel runs;
+ * the MATRIX_ISA environment variable (scalar, sse2, avx2, avx512) forces a given
+ * one for benchmarking, falling back to the best supported one below it.
+ */
+enum class Isa { Scalar, Sse2, Avx2, Avx512 };
+
+/**
+ * @return The instruction set whose kernels are in use
+ */
+Isa activeIsa();
+
+/**
+ * Switches every kernel to the given instruction set, if the CPU supports it
+ * @param isa The instruction set to use
+ * @return false (and nothing changes) if the CPU or the build lacks it
+ */
+bool setIsa(Isa isa);
+
+/**
+ * @return true if the CPU and the build support the instruction set
+ */
+bool isaSupported(Isa isa);
+
+/**
+ * @return Lower-case name of the instruction set, as accepted by MATRIX_ISA
+ */
+const char* isaName(Isa isa);
+
+/**
+ * Register-blocked GEMM micro-kernel: C[0:mr, 0:nr] += A * B, where A is a packed
+ * depth-major panel of mr rows and B a packed depth-major panel of nr columns.
+ */
+template <typename T>
+struct MicroKernel {
+    int mr; // Rows of C per call
+    int nr; // Columns of C per call
+    void (*run)(int kc, const T* a, const T* b, T* c, int ldc);
+};
+
+/**
+ * @return The micro-kernel for the active instruction set
+ */
+template <typename T>
+MicroKernel<T> microKernel();
+
+// --- Row kernels behind the elementwise operators, sumElements and the batched kernels ---
+
+// Portable loops, used for every element type and by the scalar instruction set
+namespace scalar {
+
+// out[j] = a[j] + b[j]
+template <typename T>
+void addRow(int n, const T* a, const T* b, T* out) {
+    for (int j = 0; j < n; ++j)
+        out[j] = a[j] + b[j];
+}
+
+// out[j] = a[j] - b[j]
+template <typename T>
+void subRow(int n, const T* a, const T* b, T* out) {
+    for (int j = 0; j < n; ++j)
+        out[j] = a[j] - b[j];
+}
+
+// out[j] = a[j] * b[j]
+template <typename T>
+void mulRow(int n, const T* a, const T* b, T* out) {
+    for (int j = 0; j < n; ++j)
+        out[j] = a[j] * b[j];
+}
+
+// out[j] += a[j] * b[j]
+template <typename T>
+void mulAddRow(int n, const T* a, const T* b, T* out) {
+    for (int j = 0; j < n; ++j)
+        out[j] += a[j] * b[j];
+}
+
+// out[j] = a[j] * factor
+template <typename T>
+void scaleRow(int n, const T* a, T factor, T* out) {
+    for (int j = 0; j < n; ++j)
+        out[j] = a[j] * factor;
+}
+
+// Sum of a[0:n]
+template <typename T>
+T sumRow(int n, const T* a) {
+    T total = T(0);
+    for (int j = 0; j < n; ++j)
+        total += a[j];
+    return total;
+}
+
+}
+
+// Entry points: float and double are specialized to the active instruction set
+template <typename T>
+void addRow(int n, const T* a, const T* b, T* out) {
+    scalar::addRow(n, a, b, out);
+}
+
+template <typename T>
+void subRow(int n, const T* a, const T* b, T* out) {
+    scalar::subRow(n, a, b, out);
+}
+
+template <typename T>
+void mulRow(int n, const T* a, const T* b, T* out) {
+    scalar::mulRow(n, a, b, out);
+}
+
+template <typename T>
+void mulAddRow(int n, const T* a, const T* b, T* out) {
+    scalar::mulAddRow(n, a, b, out);
+}
+
+template <typename T>
+void scaleRow(int n, const T* a, T factor, T* out) {
+    scalar::scaleRow(n, a, factor, out);
+}
+
+template <typename T>
+T sumRow(int n, const T* a) {
+    return scalar::sumRow(n, a);
+}
+
+template <> void addRow<double>(int n, const double* a, const double* b, double* out);
+template <> void subRow<double>(int n, const double* a, const double* b, double* out);
+template <> void mulRow<double>(int n, const double* a, const double* b, double* out);
+template <> void mulAddRow<double>(int n, const double* a, const double* b, double* out);
+template <> void scaleRow<double>(int n, const double* a, double factor, double* out);
+template <> double sumRow<double>(int n, const double* a);
+
+template <> void addRow<float>(int n, const float* a, const float* b, float* out);
+template <> void subRow<float>(int n, const float* a, const float* b, float* out);
+template <> void mulRow<float>(int n, const float* a, const float* b, float* out);
+template <> void mulAddRow<float>(int n, const float* a, const float* b, float* out);
+template <> void scaleRow<float>(int n, const float* a, float factor, float* out);
+template <> float sumRow<float>(int n, const float* a);
+
+/**
+ * Table of the kernels one instruction set provides for one element type
+ */
+template <typename T>
+struct IsaKernels {
+    MicroKernel<T> gemm;
+    void (*add)(int n, const T* a, const T* b, T* out);
+    void (*sub)(int n, const T* a, const T* b, T* out);
+    void (*mul)(int n, const T* a, const T* b, T* out);
+    void (*mulAdd)(int n, const T* a, const T* b, T* out);
+    void (*scale)(int n, const T* a, T factor, T* out);
+    T (*sum)(int n, const T* a);
+};
+
+#ifdef OPERATORS_X86_KERNELS
+// Per instruction set tables, defined in source/Kernels<Isa>.cpp
+namespace sse2 {
+extern const IsaKernels<double> doubleKernels;
+extern const IsaKernels<float> floatKernels;
+}
+namespace avx2 {
+extern const IsaKernels<double> doubleKernels;
+extern const IsaKernels<float> floatKernels;
+}
+namespace avx512 {
+extern const IsaKernels<double> doubleKernels;
+extern const IsaKernels<float> floatKernels;
+}
+#endif
+
+}
+}
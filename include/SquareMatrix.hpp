@@ -3,24 +3,82 @@
 #pragma once
 
 #include <iostream> // Include for std::ostream and std::endl
+#include <cstddef>  // Include for std::size_t and std::ptrdiff_t
+#include <cstdint>  // Include for std::int64_t
+#include <complex>  // Include for std::complex
+#include <memory_resource> // Include for std::pmr::memory_resource
 
 namespace operators {
 
-// Forward declaration for the friend function
-class SquareMat;
-SquareMat operator*(double scalar, const SquareMat& mat);
+/**
+ * Square matrix over the element type T.
+ * Instantiated in the library for float, double, std::int64_t and std::complex<double>;
+ * see the aliases below the class.
+ */
+template <typename T>
+class BasicSquareMat {
+public:
+    // Element type of the matrix
+    using value_type = T;
+
+    // Alignment in bytes of the buffer and of every row of a heap-stored matrix
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Matrices up to SMALL_SIZE x SMALL_SIZE are stored inside the object and never touch the heap
+    static constexpr int SMALL_SIZE = 4;
 
-class SquareMat {
 private:
-    double** data; // 2D dynamic array holding matrix elements
-    int size;      // Number of rows = columns (square matrix)
+    T* data; // Contiguous row-major buffer, rows are stride elements apart
+    int size;     // Number of rows = columns (square matrix)
+    int stride;   // Leading dimension: elements between the starts of consecutive rows
+    std::pmr::memory_resource* resource; // Where the buffer comes from, nullptr for the buffer pool
+    alignas(CACHE_LINE) T local[SMALL_SIZE * SMALL_SIZE]; // Inline storage for small matrices
+
+    // True when the elements live in local rather than in an external buffer
+    bool isInline() const { return data == local; }
+
+    // Row length rounded up to whole cache lines, padded further for power-of-two sizes
+    static int paddedStride(int n);
+
+    // Unchecked row access used by the library's own kernels; callers validate indices once
+    T* row(int i) { return data + static_cast<std::ptrdiff_t>(i) * stride; }
+    const T* row(int i) const { return data + static_cast<std::ptrdiff_t>(i) * stride; }
 
-    // Helper to allocate a size x size matrix
-    void allocate(int newSize);
+    // Helper to allocate a size x size matrix as a single block from resource (or the buffer pool),
+    // zero-filled unless every element is about to be overwritten
+    void allocate(int newSize, bool zeroFill = true);
+
+    // Tag selecting the constructor that leaves the elements uninitialized
+    struct NoInit {};
+
+    // Constructs a matrix whose elements are left uninitialized (for fully overwritten results)
+    BasicSquareMat(int size, NoInit, std::pmr::memory_resource* resource);
+
+    // Resource for matrices computed from this one: its own, or the default if it has none
+    std::pmr::memory_resource* derivedResource() const;
+
+    // The default resource: the innermost MatrixArena scope of this thread, or nullptr (buffer pool)
+    static std::pmr::memory_resource* defaultResource();
 
     // Helper to deallocate current matrix
     void deallocate();
 
+    // Copies the elements of a matrix of the same size into this one
+    void copyElements(const BasicSquareMat& other);
+
+    // Sum of all elements, backing sumElements and the comparison operators
+    T sum() const;
+
+    // this = a * b for a result buffer of the right size that aliases neither operand, backing
+    // operator* and operator^; runs in mixed precision while a MixedPrecisionScope is open
+    void assignProduct(const BasicSquareMat& a, const BasicSquareMat& b);
+
+    // this = alpha * a * b + beta * this, backing gemm and operator*=
+    void accumulateProduct(T alpha, const BasicSquareMat& a, const BasicSquareMat& b, T beta);
+
+    // Writes the rows to a stream, backing operator<<
+    void print(std::ostream& os) const;
+
 public:
     // --- Constructors and Destructor ---
 
@@ -30,25 +88,110 @@ public:
      * @param size The number of rows/columns in the matrix
      * @throws std::invalid_argument if size is not positive
      */
-    SquareMat(int size);
+    explicit BasicSquareMat(int size);
+
+    /**
+     * Constructs a zero-initialized square matrix whose storage comes from a memory resource
+     * (std::pmr resources, NUMA-aware or shared-memory allocators, a MatrixArena, ...).
+     * Matrices produced by operators on it draw from the same resource. Matrices up to
+     * SMALL_SIZE are stored inline and never call the resource.
+     * @param size The number of rows/columns in the matrix
+     * @param resource The resource to allocate from; it must outlive the matrix.
+     *                 nullptr selects the default (the innermost MatrixArena, else the buffer pool)
+     * @throws std::invalid_argument if size is not positive
+     */
+    BasicSquareMat(int size, std::pmr::memory_resource* resource);
+
+    /**
+     * Creates a square matrix without zeroing its elements.
+     * Use it only when every element is written before it is read.
+     * @param size The number of rows/columns in the matrix
+     * @param resource The resource to allocate from, nullptr for the default
+     * @return New matrix with unspecified element values
+     * @throws std::invalid_argument if size is not positive
+     */
+    static BasicSquareMat uninitialized(int size, std::pmr::memory_resource* resource = nullptr);
 
     /**
      * Copy constructor - creates a deep copy of another matrix
      * @param other The matrix to copy
      */
-    SquareMat(const SquareMat& other);
+    BasicSquareMat(const BasicSquareMat& other);
+
+    /**
+     * Copy constructor into a chosen memory resource
+     * @param other The matrix to copy
+     * @param resource The resource to allocate from, nullptr for the default
+     */
+    BasicSquareMat(const BasicSquareMat& other, std::pmr::memory_resource* resource);
+
+    /**
+     * Move constructor - takes over the buffer of another matrix
+     * @param other The matrix to move from (left empty, safe to destroy or assign to)
+     */
+    BasicSquareMat(BasicSquareMat&& other) noexcept;
 
     /**
      * Destructor - frees all allocated memory
      */
-    ~SquareMat();
+    ~BasicSquareMat();
 
     /**
      * Assignment operator - replaces the contents with a copy of another matrix
      * @param other The matrix to copy
      * @return Reference to this matrix
      */
-    SquareMat& operator=(const SquareMat& other);
+    BasicSquareMat& operator=(const BasicSquareMat& other);
+
+    /**
+     * Move assignment operator - exchanges buffers with another matrix.
+     * Falls back to copying when the two buffers come from different memory resources,
+     * so a matrix never ends up holding memory from a resource or arena scope that dies first.
+     * @param other The matrix to move from
+     * @return Reference to this matrix
+     */
+    BasicSquareMat& operator=(BasicSquareMat&& other);
+
+    /**
+     * Exchanges the contents of two matrices without copying any elements.
+     * Buffers keep their memory resource, so swapping hands that resource's memory over.
+     * @param other The matrix to swap with
+     */
+    void swap(BasicSquareMat& other) noexcept;
+
+    // --- Storage layout ---
+
+    /**
+     * @return The number of rows (= columns) of the matrix
+     */
+    int getSize() const { return size; }
+
+    /**
+     * Leading dimension of the storage: element (i, j) lives at rawData()[i * getStride() + j].
+     * Always >= getSize(). Above SMALL_SIZE every row starts on a CACHE_LINE boundary and
+     * padding elements at the end of a row hold unspecified values; small matrices are
+     * stored densely (stride == size) in a CACHE_LINE aligned inline buffer.
+     * @return Distance in elements between the starts of consecutive rows
+     */
+    int getStride() const { return stride; }
+
+    /**
+     * Direct access to the CACHE_LINE aligned storage, for hand-written kernels.
+     * The pointer is invalidated by moves and swaps of small (inline) matrices.
+     * @return Pointer to element (0, 0)
+     */
+    T* rawData() { return data; }
+
+    /**
+     * Const direct access to the CACHE_LINE aligned storage
+     * @return Const pointer to element (0, 0)
+     */
+    const T* rawData() const { return data; }
+
+    /**
+     * @return The memory resource the storage comes from, nullptr for the buffer pool
+     */
+    std::pmr::memory_resource* getResource() const { return resource; }
 
     // --- Operators in specified order ---
 
@@ -59,7 +202,7 @@ public:
      * @return New matrix containing the sum
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat operator+(const SquareMat& other) const;
+    BasicSquareMat operator+(const BasicSquareMat& other) const;
 
     // 2. Subtraction operator
     /**
@@ -68,14 +211,14 @@ public:
      * @return New matrix containing the difference
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat operator-(const SquareMat& other) const;
+    BasicSquareMat operator-(const BasicSquareMat& other) const;
 
     // 3. Unary minus
     /**
      * Negates all elements in the matrix
      * @return New matrix with negated elements
      */
-    SquareMat operator-() const;
+    BasicSquareMat operator-() const;
 
     // 4. Matrix multiplication
     /**
@@ -84,7 +227,32 @@ public:
      * @return New matrix containing the product
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat operator*(const SquareMat& other) const;
+    BasicSquareMat operator*(const BasicSquareMat& other) const;
+
+    /**
+     * Computes this * ~other without building the transpose: rows of other are read
+     * as the columns of the product
+     * @param other Matrix whose transpose is the right factor
+     * @return New matrix containing the product
+     * @throws std::invalid_argument if matrices have different sizes
+     */
+    BasicSquareMat multiplyTransposed(const BasicSquareMat& other) const;
+
+    /**
+     * Computes the Gram matrix this * ~this. The result is symmetric, so only its lower
+     * triangle is computed (about half the work of the full product) and then mirrored.
+     * multiplyTransposed(*this) takes the same path.
+     * @return New symmetric matrix containing the product
+     */
+    BasicSquareMat gram() const;
+
+    /**
+     * Computes ~this * other without building the transpose
+     * @param other Right factor
+     * @return New matrix containing the product
+     * @throws std::invalid_argument if matrices have different sizes
+     */
+    BasicSquareMat transposedMultiply(const BasicSquareMat& other) const;
 
     // 5. Scalar multiplication
     /**
@@ -92,7 +260,7 @@ public:
      * @param scalar The value to multiply by
      * @return New matrix with scaled elements
      */
-    SquareMat operator*(double scalar) const;
+    BasicSquareMat operator*(T scalar) const;
 
     // Scalar multiplication from left declared as a friend at the end
 
@@ -103,16 +271,18 @@ public:
      * @return New matrix with each element being the product of corresponding elements
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat operator%(const SquareMat& other) const;
+    BasicSquareMat operator%(const BasicSquareMat& other) const;
 
     // 7. Modulo by scalar
     /**
-     * Applies modulo operation to each element in the matrix
+     * Applies modulo operation to each element in the matrix.
+     * Integer elements use %, floating-point elements are truncated to int first,
+     * and complex elements apply it to the real and imaginary parts separately.
      * @param scalar The modulo value (integer)
      * @return New matrix with modulo applied to each element
      * @throws std::invalid_argument if scalar is zero
      */
-    SquareMat operator%(int scalar) const;
+    BasicSquareMat operator%(int scalar) const;
 
     // 8. Division by scalar
     /**
@@ -121,49 +291,61 @@ public:
      * @return New matrix with divided elements
      * @throws std::invalid_argument if scalar is zero
      */
-    SquareMat operator/(double scalar) const;
+    BasicSquareMat operator/(T scalar) const;
 
     // 9. Power operator
     /**
-     * Raises the matrix to a power
-     * @param power The exponent (non-negative integer)
+     * Raises the matrix to a power by repeated squaring, starting from the lowest set bit of the
+     * exponent instead of multiplying by the identity. Products go into three buffers allocated
+     * up front, so the loop neither allocates nor copies matrices.
+     * A negative power -k raises inverse() to k, so the matrix is factored only once.
+     * @param power The exponent
      * @return New matrix representing this matrix raised to the power
-     * @throws std::invalid_argument if power is negative
+     * @throws std::invalid_argument if power is negative and the matrix is singular or has integer elements
      */
-    SquareMat operator^(int power) const;
+    BasicSquareMat operator^(int power) const;
+
+    /**
+     * Inverse from an LU factorization with partial pivoting (see Lu.hpp). A pivot that is zero
+     * to working precision stops the factorization as soon as it appears, so singular matrices
+     * fail without a separate determinant.
+     * @return New matrix X with this * X = I
+     * @throws std::invalid_argument if the matrix is singular or has integer elements
+     */
+    BasicSquareMat inverse() const;
 
     // 10. Increment operators
     /**
      * Pre-increment operator: adds 1 to all elements
      * @return Reference to this matrix after incrementing
      */
-    SquareMat& operator++();
+    BasicSquareMat& operator++();
 
     /**
      * Post-increment operator: adds 1 to all elements
      * @return Copy of the matrix before incrementing
      */
-    SquareMat operator++(int);
+    BasicSquareMat operator++(int);
 
     // 11. Decrement operators
     /**
      * Pre-decrement operator: subtracts 1 from all elements
      * @return Reference to this matrix after decrementing
      */
-    SquareMat& operator--();
+    BasicSquareMat& operator--();
 
     /**
      * Post-decrement operator: subtracts 1 from all elements
      * @return Copy of the matrix before decrementing
      */
-    SquareMat operator--(int);
+    BasicSquareMat operator--(int);
 
     // 12. Transpose operator
     /**
      * Transposes the matrix (rows become columns and vice versa)
      * @return New transposed matrix
      */
-    SquareMat operator~() const;
+    BasicSquareMat operator~() const;
 
     // 13. Access operator
     /**
@@ -172,7 +354,7 @@ public:
      * @return Pointer to the row's data
      * @throws std::out_of_range if index is invalid
      */
-    double* operator[](int index);
+    T* operator[](int index);
 
     /**
      * Const accessor for matrix rows that allows reading elements
@@ -180,7 +362,41 @@ public:
      * @return Const pointer to the row's data
      * @throws std::out_of_range if index is invalid
      */
-    const double* operator[](int index) const;
+    const T* operator[](int index) const;
+
+    /**
+     * Unchecked element access, for hot loops where the indices are known to be valid
+     * @param i The row index (0 <= i < getSize())
+     * @param j The column index (0 <= j < getSize())
+     * @return Reference to the element; the behavior is undefined for invalid indices
+     */
+    T& operator()(int i, int j) { return row(i)[j]; }
+
+    /**
+     * Const unchecked element access
+     * @param i The row index (0 <= i < getSize())
+     * @param j The column index (0 <= j < getSize())
+     * @return Const reference to the element; the behavior is undefined for invalid indices
+     */
+    const T& operator()(int i, int j) const { return row(i)[j]; }
+
+    /**
+     * Bounds-checked element access
+     * @param i The row index
+     * @param j The column index
+     * @return Reference to the element
+     * @throws std::out_of_range if either index is invalid
+     */
+    T& at(int i, int j);
+
+    /**
+     * Const bounds-checked element access
+     * @param i The row index
+     * @param j The column index
+     * @return Const reference to the element
+     * @throws std::out_of_range if either index is invalid
+     */
+    const T& at(int i, int j) const;
 
     // 14. Equality operator
     /**
@@ -188,7 +404,7 @@ public:
      * @param other Matrix to compare with
      * @return true if matrices have equal sums, false otherwise
      */
-    bool operator==(const SquareMat& other) const;
+    bool operator==(const BasicSquareMat& other) const;
 
     // 15. Inequality operator
     /**
@@ -196,43 +412,44 @@ public:
      * @param other Matrix to compare with
      * @return true if matrices have unequal sums, false otherwise
      */
-    bool operator!=(const SquareMat& other) const;
+    bool operator!=(const BasicSquareMat& other) const;
 
     // Extra comparison operators not in the list but in original code
+    // (complex matrices order their sums by magnitude)
     /**
      * Less than operator - compares the sum of elements
      * @param other Matrix to compare with
      * @return true if this matrix's sum is less than other's sum
      */
-    bool operator<(const SquareMat& other) const;
+    bool operator<(const BasicSquareMat& other) const;
 
     /**
      * Greater than operator - compares the sum of elements
      * @param other Matrix to compare with
      * @return true if this matrix's sum is greater than other's sum
      */
-    bool operator>(const SquareMat& other) const;
+    bool operator>(const BasicSquareMat& other) const;
 
     /**
      * Less than or equal to operator - compares the sum of elements
      * @param other Matrix to compare with
      * @return true if this matrix's sum is less than or equal to other's sum
      */
-    bool operator<=(const SquareMat& other) const;
+    bool operator<=(const BasicSquareMat& other) const;
 
     /**
      * Greater than or equal to operator - compares the sum of elements
      * @param other Matrix to compare with
      * @return true if this matrix's sum is greater than or equal to other's sum
      */
-    bool operator>=(const SquareMat& other) const;
+    bool operator>=(const BasicSquareMat& other) const;
 
     // 16. Determinant operator
     /**
      * Determinant operator - calculates the determinant of the matrix
      * @return The determinant value
      */
-    double operator!() const;
+    T operator!() const;
 
     // 17. Compound assignment operators
     /**
@@ -241,7 +458,7 @@ public:
      * @return Reference to this matrix after addition
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat& operator+=(const SquareMat& other);
+    BasicSquareMat& operator+=(const BasicSquareMat& other);
 
     /**
      * Subtracts another matrix from this matrix in-place
@@ -249,7 +466,7 @@ public:
      * @return Reference to this matrix after subtraction
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat& operator-=(const SquareMat& other);
+    BasicSquareMat& operator-=(const BasicSquareMat& other);
 
     /**
      * Multiplies this matrix by another matrix in-place
@@ -257,7 +474,7 @@ public:
      * @return Reference to this matrix after multiplication
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat& operator*=(const SquareMat& other);
+    BasicSquareMat& operator*=(const BasicSquareMat& other);
 
     /**
      * Divides all elements by a scalar in-place
@@ -265,7 +482,7 @@ public:
      * @return Reference to this matrix after division
      * @throws std::invalid_argument if scalar is zero
      */
-    SquareMat& operator/=(double scalar);
+    BasicSquareMat& operator/=(T scalar);
 
     /**
      * Applies modulo operation to all elements in-place
@@ -273,7 +490,7 @@ public:
      * @return Reference to this matrix after modulo
      * @throws std::invalid_argument if scalar is zero
      */
-    SquareMat& operator%=(int scalar);
+    BasicSquareMat& operator%=(int scalar);
 
     /**
      * Performs element-wise multiplication with another matrix in-place
@@ -281,7 +498,7 @@ public:
      * @return Reference to this matrix after operation
      * @throws std::invalid_argument if matrices have different sizes
      */
-    SquareMat& operator%=(const SquareMat& other);
+    BasicSquareMat& operator%=(const BasicSquareMat& other);
 
     // --- Friend functions ---
 
@@ -291,10 +508,33 @@ public:
      * @param mat Matrix whose elements to sum
      * @return Sum of all elements
      */
-    friend double sumElements(const SquareMat& mat);
+    friend T sumElements(const BasicSquareMat& mat) { return mat.sum(); }
+
+    /**
+     * In-place matrix product: c = alpha * a * b + beta * c, written straight into c's storage,
+     * so accumulations like `gemm(1.0, A, B, 1.0, acc)` need no temporaries.
+     * c may be a or b; the product then goes through a scratch buffer that replaces c's storage.
+     * When beta is zero the old contents of c are ignored.
+     * @param alpha Scale of the product
+     * @param a Left factor
+     * @param b Right factor
+     * @param beta Scale of the previous contents of c
+     * @param c Matrix receiving the result
+     * @throws std::invalid_argument if matrices have different sizes
+     */
+    friend void gemm(T alpha, const BasicSquareMat& a, const BasicSquareMat& b, T beta, BasicSquareMat& c) {
+        c.accumulateProduct(alpha, a, b, beta);
+    }
+
+    /**
+     * Non-member swap so that std::swap-style calls find the cheap version
+     */
+    friend void swap(BasicSquareMat& a, BasicSquareMat& b) noexcept { a.swap(b); }
 
     // 5b. Scalar multiplication from left side
-    friend SquareMat operator*(double scalar, const SquareMat& mat);
+    friend BasicSquareMat operator*(T scalar, const BasicSquareMat& mat) {
+        return mat * scalar; // Reuse the existing method
+    }
 
     // 18. Output operator
     /**
@@ -303,7 +543,40 @@ public:
      * @param mat Matrix to output
      * @return Reference to the output stream
      */
-    friend std::ostream& operator<<(std::ostream& os, const SquareMat& mat);
+    friend std::ostream& operator<<(std::ostream& os, const BasicSquareMat& mat) {
+        mat.print(os);
+        return os;
+    }
 };
 
+// Element types compiled into the library (source/SquareMatrix.cpp)
+extern template class BasicSquareMat<float>;
+extern template class BasicSquareMat<double>;
+extern template class BasicSquareMat<std::int64_t>;
+extern template class BasicSquareMat<std::complex<double>>;
+
+// Double precision matrix, the original SquareMat
+using SquareMat = BasicSquareMat<double>;
+
+// Single precision matrix: twice the SIMD width and half the bandwidth of SquareMat
+using FloatSquareMat = BasicSquareMat<float>;
+
+// Exact integer matrix, for counting; operator% works on the integers directly
+using IntSquareMat = BasicSquareMat<std::int64_t>;
+
+// Complex matrix
+using ComplexSquareMat = BasicSquareMat<std::complex<double>>;
+
+/**
+ * Modular matrix power: a^power mod modulus, reduced after every product so nothing overflows
+ * however large the exponent (linear recurrences, path counting). Uses the squaring schedule
+ * and buffers of operator^, with products from kernels::gemmMod (multithreaded for large sizes).
+ * @param a The matrix; elements are first reduced into [0, modulus), negative ones included
+ * @param power The exponent (non-negative, up to about 9.2e18)
+ * @param modulus The modulus (positive, up to 2^63 - 1)
+ * @return New matrix with elements in [0, modulus)
+ * @throws std::invalid_argument if power is negative or modulus is not positive
+ */
+IntSquareMat powMod(const IntSquareMat& a, std::int64_t power, std::int64_t modulus);
+
 } 
@@ -0,0 +1,250 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include "SquareMatrix.hpp"
+#include <cstddef> // Include for std::size_t
+#include <vector>  // Include for std::vector
+
+namespace operators {
+
+/**
+ * Many same-size square matrices stored together in structure-of-arrays layout.
+ *
+ * Element (i, j) of every matrix in the batch lives in one contiguous plane, so the
+ * operators below run each step across all matrices at once with the vectorized row
+ * kernels instead of looping over the small matrices one by one. This is the layout
+ * for processing large numbers of 3x3 or 4x4 matrices:
+ *
+ *     SquareMatBatch batch(matrices);        // vector of SquareMat, all the same size
+ *     SquareMatBatch squared = batch * batch; // one product per matrix
+ *     std::vector<double> dets = !squared;   // one determinant per matrix
+ *     SquareMat first = squared.get(0);
+ *
+ * The storage is one CACHE_LINE aligned block from the buffer pool.
+ */
+template <typename T>
+class BasicSquareMatBatch {
+public:
+    // Element type of the matrices
+    using value_type = T;
+
+    // Alignment in bytes of the buffer and of every plane
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Largest size whose determinants are computed across the batch; larger sizes go one by one
+    static constexpr int BATCH_DETERMINANT_LIMIT = 8;
+
+private:
+    T* data;         // size * size planes, plane (i, j) holds element (i, j) of every matrix
+    int size;        // Number of rows = columns of each matrix
+    int count;       // Number of matrices
+    int planeStride; // Elements between the starts of consecutive planes (count rounded up to cache lines)
+
+    // Unchecked plane access used by the kernels
+    T* plane(int i, int j) { return data + static_cast<std::ptrdiff_t>(i * size + j) * planeStride; }
+    const T* plane(int i, int j) const { return data + static_cast<std::ptrdiff_t>(i * size + j) * planeStride; }
+
+    // Helper to allocate the planes from the buffer pool, zero-filled unless about to be overwritten
+    void allocate(int newSize, int newCount, bool zeroFill = true);
+
+    // Helper to return the planes to the buffer pool
+    void deallocate();
+
+    // Tag selecting the constructor that leaves the elements uninitialized
+    struct NoInit {};
+
+    // Constructs a batch whose elements are left uninitialized (for fully overwritten results)
+    BasicSquareMatBatch(int size, int count, NoInit);
+
+    // Throws std::invalid_argument unless other holds as many matrices of the same size
+    void checkShape(const BasicSquareMatBatch& other) const;
+
+    // Throws std::out_of_range unless index names a matrix of the batch
+    void checkIndex(int index) const;
+
+public:
+    // --- Constructors and Destructor ---
+
+    /**
+     * Constructs a batch of count zero matrices
+     * @param size The number of rows/columns of each matrix
+     * @param count The number of matrices
+     * @throws std::invalid_argument if size is not positive or count is negative
+     */
+    BasicSquareMatBatch(int size, int count);
+
+    /**
+     * Gathers individual matrices into a batch
+     * @param matrices The matrices, all of the same size
+     * @throws std::invalid_argument if matrices is empty or the sizes differ
+     */
+    explicit BasicSquareMatBatch(const std::vector<BasicSquareMat<T>>& matrices);
+
+    /**
+     * @param size The number of rows/columns of each matrix
+     * @param count The number of matrices
+     * @return Batch of count identity matrices
+     * @throws std::invalid_argument if size is not positive or count is negative
+     */
+    static BasicSquareMatBatch identity(int size, int count);
+
+    /**
+     * Copy constructor - creates a deep copy of another batch
+     * @param other The batch to copy
+     */
+    BasicSquareMatBatch(const BasicSquareMatBatch& other);
+
+    /**
+     * Move constructor - takes over the planes of another batch
+     * @param other The batch to move from (left empty, safe to destroy or assign to)
+     */
+    BasicSquareMatBatch(BasicSquareMatBatch&& other) noexcept;
+
+    /**
+     * Destructor - frees all allocated memory
+     */
+    ~BasicSquareMatBatch();
+
+    /**
+     * Assignment operator - replaces the contents with a copy of another batch
+     * @param other The batch to copy
+     * @return Reference to this batch
+     */
+    BasicSquareMatBatch& operator=(const BasicSquareMatBatch& other);
+
+    /**
+     * Move assignment operator - exchanges planes with another batch
+     * @param other The batch to move from
+     * @return Reference to this batch
+     */
+    BasicSquareMatBatch& operator=(BasicSquareMatBatch&& other) noexcept;
+
+    // --- Storage layout and conversions ---
+
+    /**
+     * @return The number of rows (= columns) of each matrix
+     */
+    int getSize() const { return size; }
+
+    /**
+     * @return The number of matrices in the batch
+     */
+    int getCount() const { return count; }
+
+    /**
+     * Unchecked element access
+     * @param index The matrix (0 <= index < getCount())
+     * @param i The row index (0 <= i < getSize())
+     * @param j The column index (0 <= j < getSize())
+     * @return Reference to element (i, j) of matrix index
+     */
+    T& operator()(int index, int i, int j) { return plane(i, j)[index]; }
+
+    /**
+     * Const unchecked element access
+     * @param index The matrix (0 <= index < getCount())
+     * @param i The row index (0 <= i < getSize())
+     * @param j The column index (0 <= j < getSize())
+     * @return Const reference to element (i, j) of matrix index
+     */
+    const T& operator()(int index, int i, int j) const { return plane(i, j)[index]; }
+
+    /**
+     * Copies one matrix out of the batch
+     * @param index The matrix to copy
+     * @return New matrix with the elements of matrix index
+     * @throws std::out_of_range if index is invalid
+     */
+    BasicSquareMat<T> get(int index) const;
+
+    /**
+     * Overwrites one matrix of the batch
+     * @param index The matrix to overwrite
+     * @param mat The new elements
+     * @throws std::out_of_range if index is invalid
+     * @throws std::invalid_argument if mat has a different size
+     */
+    void set(int index, const BasicSquareMat<T>& mat);
+
+    /**
+     * Scatters the batch back into individual matrices
+     * @return One matrix per entry of the batch, in order
+     */
+    std::vector<BasicSquareMat<T>> toMatrices() const;
+
+    // --- Batched operators, applied to each matrix ---
+
+    /**
+     * Adds two batches matrix-by-matrix
+     * @param other Batch to add
+     * @return New batch containing the sums
+     * @throws std::invalid_argument if the batches differ in size or count
+     */
+    BasicSquareMatBatch operator+(const BasicSquareMatBatch& other) const;
+
+    /**
+     * Subtracts another batch matrix-by-matrix
+     * @param other Batch to subtract
+     * @return New batch containing the differences
+     * @throws std::invalid_argument if the batches differ in size or count
+     */
+    BasicSquareMatBatch operator-(const BasicSquareMatBatch& other) const;
+
+    /**
+     * Multiplies every matrix by the matrix at the same index of another batch
+     * @param other Batch of right factors
+     * @return New batch containing the products
+     * @throws std::invalid_argument if the batches differ in size or count
+     */
+    BasicSquareMatBatch operator*(const BasicSquareMatBatch& other) const;
+
+    /**
+     * Multiplies every element by a scalar
+     * @param scalar The value to multiply by
+     * @return New batch with scaled elements
+     */
+    BasicSquareMatBatch operator*(T scalar) const;
+
+    /**
+     * Raises every matrix to the same power by repeated squaring, without multiplying by the identity
+     * @param power The exponent (non-negative integer)
+     * @return New batch of the powers
+     * @throws std::invalid_argument if power is negative
+     */
+    BasicSquareMatBatch operator^(int power) const;
+
+    /**
+     * Transposes every matrix
+     * @return New batch of the transposes
+     */
+    BasicSquareMatBatch operator~() const;
+
+    /**
+     * Determinant of every matrix. Up to BATCH_DETERMINANT_LIMIT the minors of the bottom rows
+     * are built up across the batch; the result matches operator! of each matrix
+     * (exactly for integer elements)
+     * @return One determinant per matrix, in order
+     */
+    std::vector<T> operator!() const;
+};
+
+// Element types compiled into the library (source/SquareMatrixBatch.cpp)
+extern template class BasicSquareMatBatch<float>;
+extern template class BasicSquareMatBatch<double>;
+extern template class BasicSquareMatBatch<std::int64_t>;
+extern template class BasicSquareMatBatch<std::complex<double>>;
+
+// Batch of SquareMat
+using SquareMatBatch = BasicSquareMatBatch<double>;
+
+// Batch of FloatSquareMat
+using FloatSquareMatBatch = BasicSquareMatBatch<float>;
+
+// Batch of IntSquareMat
+using IntSquareMatBatch = BasicSquareMatBatch<std::int64_t>;
+
+// Batch of ComplexSquareMat
+using ComplexSquareMatBatch = BasicSquareMatBatch<std::complex<double>>;
+
+}
@@ -0,0 +1,40 @@
+// Author: realyoavperetz@gmail.com
+
+#pragma once
+
+#include <functional> // Include for std::function
+
+namespace operators {
+
+/**
+ * Process-wide pool of worker threads used by the matrix kernels.
+ *
+ * The pool starts with one thread per hardware thread, or with the number given
+ * in the MATRIX_THREADS environment variable. Workers are created on first use and
+ * sleep between jobs. The calling thread always takes part in a job, so a count of 1
+ * runs everything inline. A job started from inside another job also runs inline.
+ */
+class ThreadPool {
+public:
+    /**
+     * Sets the number of threads jobs run on, including the caller.
+     * Existing workers are joined and the new ones start with the next job.
+     * @param count Thread count; 0 restores the default
+     */
+    static void setThreadCount(int count);
+
+    /**
+     * @return The number of threads jobs run on, including the caller
+     */
+    static int threadCount();
+
+    /**
+     * Runs task(0), ..., task(count - 1) across the pool and returns when all are done
+     * @param count Number of tasks
+     * @param task Called once per index, possibly concurrently
+     * @throws Whatever the first failing task threw, after every task has finished
+     */
+    static void parallelFor(int count, const std::function<void(int)>& task);
+};
+
+}
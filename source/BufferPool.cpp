@@ -0,0 +1,172 @@
+// Author: realyoavperetz@gmail.com
+
+#include "BufferPool.hpp"
+#include <atomic>
+#include <new>
+
+namespace operators {
+
+#ifdef MATRIX_NO_POOL
+
+// Pool bypassed at compile time: every buffer goes straight to the system allocator
+void* BufferPool::acquire(std::size_t bytes) {
+    return ::operator new(bytes, std::align_val_t(ALIGNMENT));
+}
+
+void BufferPool::release(void* ptr, std::size_t) {
+    if (ptr)
+        ::operator delete(ptr, std::align_val_t(ALIGNMENT));
+}
+
+void BufferPool::setCapacity(std::size_t) {}
+
+std::size_t BufferPool::capacity() {
+    return 0;
+}
+
+std::size_t BufferPool::cachedBytes() {
+    return 0;
+}
+
+void BufferPool::trim(std::size_t) {}
+
+#else
+
+// Buffers larger than this are never cached
+static constexpr int MAX_POOLED_SHIFT = 30;
+
+// Class 0 holds buffers up to ALIGNMENT bytes, then four classes per power of two
+static constexpr int MIN_SHIFT = 6;
+static constexpr int CLASS_COUNT = 4 * (MAX_POOLED_SHIFT - MIN_SHIFT) + 1;
+
+static_assert((std::size_t(1) << MIN_SHIFT) == BufferPool::ALIGNMENT,
+              "Smallest class must be one alignment unit");
+
+// Cap shared by all threads
+static std::atomic<std::size_t> poolCapacity(BufferPool::DEFAULT_CAPACITY);
+
+// Freed buffer, reused as a free-list node
+struct FreeBuffer {
+    FreeBuffer* next;
+};
+
+// Per-thread free lists, one per size class
+struct ThreadFreeLists {
+    FreeBuffer* lists[CLASS_COUNT] = {};
+    std::size_t cached = 0;
+
+    ~ThreadFreeLists();
+};
+
+static thread_local ThreadFreeLists threadFreeLists;
+static thread_local bool threadFreeListsDestroyed = false; // Trivial type, so readable during thread exit
+
+// Map a request to its size class; returns -1 for requests that are not pooled
+static int classOf(std::size_t bytes, std::size_t& classBytes) {
+    if (bytes <= BufferPool::ALIGNMENT) {
+        classBytes = BufferPool::ALIGNMENT;
+        return 0;
+    }
+    if (bytes > (std::size_t(1) << MAX_POOLED_SHIFT))
+        return -1;
+    int shift = MIN_SHIFT; // Largest power of two strictly below bytes
+    while ((std::size_t(2) << shift) < bytes)
+        ++shift;
+    const std::size_t base = std::size_t(1) << shift;
+    const std::size_t quarter = base / 4;
+    const std::size_t steps = (bytes - base + quarter - 1) / quarter; // 1..4
+    classBytes = base + steps * quarter;
+    return 4 * (shift - MIN_SHIFT) + static_cast<int>(steps);
+}
+
+// Size in bytes of the buffers of a class
+static std::size_t bytesOfClass(int index) {
+    if (index == 0)
+        return BufferPool::ALIGNMENT;
+    const int shift = MIN_SHIFT + (index - 1) / 4;
+    const std::size_t steps = (index - 1) % 4 + 1;
+    return (std::size_t(1) << shift) + steps * ((std::size_t(1) << shift) / 4);
+}
+
+// Free cached buffers, largest classes first, until at most target bytes remain
+static void trimPool(ThreadFreeLists& pool, std::size_t target) {
+    for (int index = CLASS_COUNT - 1; index >= 0 && pool.cached > target; --index) {
+        const std::size_t classBytes = bytesOfClass(index);
+        while (pool.lists[index] && pool.cached > target) {
+            FreeBuffer* buffer = pool.lists[index];
+            pool.lists[index] = buffer->next;
+            pool.cached -= classBytes;
+            ::operator delete(buffer, std::align_val_t(BufferPool::ALIGNMENT));
+        }
+    }
+}
+
+// Hand every cached buffer back when the thread exits
+ThreadFreeLists::~ThreadFreeLists() {
+    trimPool(*this, 0);
+    threadFreeListsDestroyed = true;
+}
+
+// Reuse a cached buffer of the right class, or get a new one sized to the class
+void* BufferPool::acquire(std::size_t bytes) {
+    std::size_t classBytes = bytes;
+    const int index = classOf(bytes, classBytes);
+    if (index >= 0 && !threadFreeListsDestroyed) {
+        ThreadFreeLists& pool = threadFreeLists;
+        if (FreeBuffer* buffer = pool.lists[index]) {
+            pool.lists[index] = buffer->next;
+            pool.cached -= classBytes;
+            return buffer;
+        }
+    }
+    return ::operator new(classBytes, std::align_val_t(ALIGNMENT));
+}
+
+// Cache the buffer on this thread unless that would exceed the cap
+void BufferPool::release(void* ptr, std::size_t bytes) {
+    if (!ptr)
+        return;
+    std::size_t classBytes = bytes;
+    const int index = classOf(bytes, classBytes);
+    if (index >= 0 && !threadFreeListsDestroyed) {
+        ThreadFreeLists& pool = threadFreeLists;
+        const std::size_t cap = poolCapacity.load(std::memory_order_relaxed);
+        if (pool.cached > cap)
+            trimPool(pool, cap);
+        if (pool.cached + classBytes <= cap) {
+            FreeBuffer* buffer = static_cast<FreeBuffer*>(ptr);
+            buffer->next = pool.lists[index];
+            pool.lists[index] = buffer;
+            pool.cached += classBytes;
+            return;
+        }
+    }
+    ::operator delete(ptr, std::align_val_t(ALIGNMENT));
+}
+
+// Set the per-thread cap and apply it to the calling thread right away
+void BufferPool::setCapacity(std::size_t bytes) {
+    poolCapacity.store(bytes, std::memory_order_relaxed);
+    if (!threadFreeListsDestroyed)
+        trimPool(threadFreeLists, bytes);
+}
+
+// Per-thread cap
+std::size_t BufferPool::capacity() {
+    return poolCapacity.load(std::memory_order_relaxed);
+}
+
+// Bytes cached by the calling thread
+std::size_t BufferPool::cachedBytes() {
+    return threadFreeListsDestroyed ? 0 : threadFreeLists.cached;
+}
+
+// Free the calling thread's cache down to the target
+void BufferPool::trim(std::size_t targetBytes) {
+    if (!threadFreeListsDestroyed)
+        trimPool(threadFreeLists, targetBytes);
+}
+
+#endif
+
+}
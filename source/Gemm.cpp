@@ -0,0 +1,730 @@
+// Author: realyoavperetz@gmail.com
+
+#include "Gemm.hpp"
+#include "BufferPool.hpp"
+#include "SimdKernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace operators {
+namespace kernels {
+
+// Below this size packing costs more than it saves
+static constexpr int DIRECT_LIMIT = 48;
+
+// Below this size the product stays on the calling thread
+static constexpr int PARALLEL_LIMIT = 256;
+
+// Strassen-Winograd starts paying for its extra additions around this size
+static constexpr int DEFAULT_STRASSEN_CROSSOVER = 2048;
+
+// Side of the square output tiles of syrk; a multiple of every micro-tile shape
+static constexpr int SYRK_BLOCK = 192;
+
+// Largest micro-kernel tile, in elements; edge tiles are computed in a buffer this big
+static constexpr int MAX_TILE = 256;
+
+// Profile loaded on first use when MATRIX_TUNING does not name another one
+static constexpr const char* DEFAULT_TUNING_PROFILE = "gemm.tuning";
+
+// Element types with their own blocking, by their name in the tuning profile
+static constexpr int TUNED_TYPES = 4;
+static const char* const TUNED_TYPE_NAMES[TUNED_TYPES] = {"float", "double", "int64", "complex"};
+
+template <typename T>
+static constexpr int tunedTypeIndex() {
+    if constexpr (std::is_same<T, float>::value)
+        return 0;
+    else if constexpr (std::is_same<T, double>::value)
+        return 1;
+    else if constexpr (std::is_same<T, std::int64_t>::value)
+        return 2;
+    else
+        return 3;
+}
+
+// Blocking overrides of one instruction set and element type; zero fields keep the built-in size
+struct TunedBlocking {
+    std::atomic<int> mc{0};
+    std::atomic<int> kc{0};
+    std::atomic<int> nc{0};
+};
+
+static constexpr int TUNED_ISAS = static_cast<int>(Isa::Avx512) + 1;
+
+using TuningTable = TunedBlocking[TUNED_ISAS][TUNED_TYPES];
+
+static TuningTable& tuningTable() {
+    static TuningTable table;
+    return table;
+}
+
+// Fills the table from "isa type mc kc nc" lines, skipping comments and lines it does not recognize
+static bool readProfile(const char* path) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string isaField, typeField;
+        int mc = 0, kc = 0, nc = 0;
+        if (!(fields >> isaField >> typeField >> mc >> kc >> nc) || mc < 0 || kc < 0 || nc < 0)
+            continue;
+        for (int isa = 0; isa < TUNED_ISAS; ++isa) {
+            if (isaField != isaName(static_cast<Isa>(isa)))
+                continue;
+            for (int type = 0; type < TUNED_TYPES; ++type) {
+                if (typeField != TUNED_TYPE_NAMES[type])
+                    continue;
+                TunedBlocking& tuned = tuningTable()[isa][type];
+                tuned.mc.store(mc, std::memory_order_relaxed);
+                tuned.kc.store(kc, std::memory_order_relaxed);
+                tuned.nc.store(nc, std::memory_order_relaxed);
+            }
+        }
+    }
+    return true;
+}
+
+// Loads MATRIX_TUNING, or the default profile, once; a missing file leaves the built-in sizes
+static void loadStartupProfile() {
+    static const bool loaded = [] {
+        const char* path = std::getenv("MATRIX_TUNING");
+        return readProfile(path ? path : DEFAULT_TUNING_PROFILE);
+    }();
+    (void)loaded;
+}
+
+bool loadTuningProfile(const char* path) {
+    loadStartupProfile(); // So the startup profile cannot overwrite this one later
+    return readProfile(path);
+}
+
+bool saveTuningProfile(const char* path) {
+    loadStartupProfile();
+    std::ofstream out(path);
+    out << "# GEMM blocking per instruction set and element type: isa type mc kc nc (0 = built-in)\n";
+    for (int isa = 0; isa < TUNED_ISAS; ++isa) {
+        for (int type = 0; type < TUNED_TYPES; ++type) {
+            const TunedBlocking& tuned = tuningTable()[isa][type];
+            const int mc = tuned.mc.load(std::memory_order_relaxed);
+            const int kc = tuned.kc.load(std::memory_order_relaxed);
+            const int nc = tuned.nc.load(std::memory_order_relaxed);
+            if (mc != 0 || kc != 0 || nc != 0)
+                out << isaName(static_cast<Isa>(isa)) << ' ' << TUNED_TYPE_NAMES[type] << ' ' << mc << ' ' << kc
+                    << ' ' << nc << '\n';
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+// Blocking from the tuning profile, or sized for a 32 KiB L1, a few hundred KiB of L2 and
+// a few MiB of L3; mc and nc are rounded to the tile of the active micro-kernel
+template <typename T>
+static GemmBlocking blockingFor(const MicroKernel<T>& kernel) {
+    loadStartupProfile();
+    const TunedBlocking& tuned = tuningTable()[static_cast<int>(activeIsa())][tunedTypeIndex<T>()];
+    const int tunedMc = tuned.mc.load(std::memory_order_relaxed);
+    const int tunedKc = tuned.kc.load(std::memory_order_relaxed);
+    const int tunedNc = tuned.nc.load(std::memory_order_relaxed);
+    const int kc = tunedKc > 0 ? tunedKc : static_cast<int>(2048 / sizeof(T));
+    const int mc = std::max(tunedMc > 0 ? tunedMc : 128, kernel.mr) / kernel.mr * kernel.mr;
+    const int nc = std::max(tunedNc > 0 ? tunedNc : 4096, kernel.nr) / kernel.nr * kernel.nr;
+    return GemmBlocking{mc, kc, nc};
+}
+
+template <typename T>
+GemmBlocking gemmBlocking() {
+    return blockingFor(microKernel<T>());
+}
+
+template <typename T>
+void setGemmBlocking(GemmBlocking blocking) {
+    loadStartupProfile();
+    TunedBlocking& tuned = tuningTable()[static_cast<int>(activeIsa())][tunedTypeIndex<T>()];
+    tuned.mc.store(std::max(blocking.mc, 0), std::memory_order_relaxed);
+    tuned.kc.store(std::max(blocking.kc, 0), std::memory_order_relaxed);
+    tuned.nc.store(std::max(blocking.nc, 0), std::memory_order_relaxed);
+}
+
+// C = beta * C, without reading C when beta is zero
+template <typename T>
+static void scaleRows(int n, T beta, T* c, int ldc) {
+    if (beta == T(1))
+        return;
+    for (int i = 0; i < n; ++i) {
+        T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        for (int j = 0; j < n; ++j)
+            ci[j] = beta == T(0) ? T(0) : ci[j] * beta;
+    }
+}
+
+// Read-only view of op(X): the stored matrix X or its transpose, never materialized
+template <typename T>
+struct Operand {
+    const T* data;
+    int ld;
+    bool trans;
+
+    // Element (i, j) of op(X)
+    const T& at(int i, int j) const {
+        return trans ? data[static_cast<std::ptrdiff_t>(j) * ld + i] : data[static_cast<std::ptrdiff_t>(i) * ld + j];
+    }
+
+    // op(X) starting at (row, col); for a transpose this lands on the mirrored block of X
+    Operand block(int row, int col) const {
+        return {trans ? data + static_cast<std::ptrdiff_t>(col) * ld + row
+                      : data + static_cast<std::ptrdiff_t>(row) * ld + col,
+                ld, trans};
+    }
+};
+
+// Small products: i-k-j loops that stream rows of B and C, or dot products of
+// contiguous rows when B is transposed
+template <typename T>
+static void gemmDirect(int n, T alpha, Operand<T> a, Operand<T> b, T* c, int ldc) {
+    for (int i = 0; i < n; ++i) {
+        T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        if (b.trans) {
+            for (int j = 0; j < n; ++j) {
+                const T* bj = b.data + static_cast<std::ptrdiff_t>(j) * b.ld;
+                T dot = T(0);
+                for (int k = 0; k < n; ++k)
+                    dot += a.at(i, k) * bj[k];
+                ci[j] += alpha * dot;
+            }
+            continue;
+        }
+        for (int k = 0; k < n; ++k) {
+            const T aik = alpha * a.at(i, k);
+            const T* bk = b.data + static_cast<std::ptrdiff_t>(k) * b.ld;
+            for (int j = 0; j < n; ++j)
+                ci[j] += aik * bk[j];
+        }
+    }
+}
+
+// Pack an mc x kc block of alpha * op(A) into mr-row micro-panels stored depth-major,
+// zero-padding the last panel so the micro-kernel never needs edge cases
+template <typename T>
+static void packA(int mc, int kc, T alpha, Operand<T> a, int mr, T* packed) {
+    for (int ir = 0; ir < mc; ir += mr) {
+        const int rows = mc - ir < mr ? mc - ir : mr;
+        for (int p = 0; p < kc; ++p) {
+            if (a.trans) {
+                const T* ap = a.data + static_cast<std::ptrdiff_t>(p) * a.ld + ir; // Contiguous in A's row p
+                for (int i = 0; i < rows; ++i)
+                    packed[i] = alpha * ap[i];
+            } else {
+                for (int i = 0; i < rows; ++i)
+                    packed[i] = alpha * a.data[static_cast<std::ptrdiff_t>(ir + i) * a.ld + p];
+            }
+            for (int i = rows; i < mr; ++i)
+                packed[i] = T(0);
+            packed += mr;
+        }
+    }
+}
+
+// Pack a kc x nc block of op(B) into nr-column micro-panels stored depth-major
+template <typename T>
+static void packB(int kc, int nc, Operand<T> b, int nr, T* packed) {
+    for (int jr = 0; jr < nc; jr += nr) {
+        const int cols = nc - jr < nr ? nc - jr : nr;
+        for (int p = 0; p < kc; ++p) {
+            if (b.trans) {
+                const T* bp = b.data + static_cast<std::ptrdiff_t>(jr) * b.ld + p; // Down B's column p
+                for (int j = 0; j < cols; ++j)
+                    packed[j] = bp[static_cast<std::ptrdiff_t>(j) * b.ld];
+            } else {
+                const T* bp = b.data + static_cast<std::ptrdiff_t>(p) * b.ld + jr;
+                for (int j = 0; j < cols; ++j)
+                    packed[j] = bp[j];
+            }
+            for (int j = cols; j < nr; ++j)
+                packed[j] = T(0);
+            packed += nr;
+        }
+    }
+}
+
+// C[0:mr, 0:nr] += A panel * B panel; partial tiles go through a scratch tile
+template <typename T>
+static void runTile(const MicroKernel<T>& kernel, int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr) {
+    if (mr == kernel.mr && nr == kernel.nr) {
+        kernel.run(kc, a, b, c, ldc);
+        return;
+    }
+    T tile[MAX_TILE];
+    for (int i = 0; i < kernel.mr * kernel.nr; ++i)
+        tile[i] = T(0);
+    kernel.run(kc, a, b, tile, kernel.nr);
+    for (int i = 0; i < mr; ++i)
+        for (int j = 0; j < nr; ++j)
+            c[static_cast<std::ptrdiff_t>(i) * ldc + j] += tile[i * kernel.nr + j];
+}
+
+// Blocked m x n += alpha * op(A) (m x k) * op(B) (k x n) over packed panels
+// (Goto/BLIS loop order: jc, pc, ic, jr, ir)
+template <typename T>
+static void gemmBlocked(int m, int n, int k, T alpha, Operand<T> a, Operand<T> b, T* c, int ldc) {
+    const MicroKernel<T> kernel = microKernel<T>();
+    const int MR = kernel.mr;
+    const int NR = kernel.nr;
+    const GemmBlocking blocking = blockingFor(kernel);
+    const int mcMax = m < blocking.mc ? (m + MR - 1) / MR * MR : blocking.mc;
+    const int ncMax = n < blocking.nc ? (n + NR - 1) / NR * NR : blocking.nc;
+    const int kcMax = k < blocking.kc ? k : blocking.kc;
+    const std::size_t aBytes = sizeof(T) * mcMax * kcMax;
+    const std::size_t bBytes = sizeof(T) * ncMax * kcMax;
+    T* packedA = static_cast<T*>(BufferPool::acquire(aBytes));
+    T* packedB = static_cast<T*>(BufferPool::acquire(bBytes));
+
+    for (int jc = 0; jc < n; jc += blocking.nc) {
+        const int nc = n - jc < blocking.nc ? n - jc : blocking.nc;
+        for (int pc = 0; pc < k; pc += blocking.kc) {
+            const int kc = k - pc < blocking.kc ? k - pc : blocking.kc;
+            packB(kc, nc, b.block(pc, jc), NR, packedB);
+            for (int ic = 0; ic < m; ic += blocking.mc) {
+                const int mc = m - ic < blocking.mc ? m - ic : blocking.mc;
+                packA(mc, kc, alpha, a.block(ic, pc), MR, packedA);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    const int nr = nc - jr < NR ? nc - jr : NR;
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        const int mr = mc - ir < MR ? mc - ir : MR;
+                        runTile(kernel, kc, packedA + static_cast<std::ptrdiff_t>(ir) * kc,
+                                packedB + static_cast<std::ptrdiff_t>(jr) * kc,
+                                c + static_cast<std::ptrdiff_t>(ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                    }
+                }
+            }
+        }
+    }
+
+    BufferPool::release(packedB, bBytes);
+    BufferPool::release(packedA, aBytes);
+}
+
+// Largest divisor of count that is at most its square root, so rows x cols tiles cover
+// the pool exactly with tiles as square as possible
+static int tileRowsFor(int count) {
+    int rows = 1;
+    for (int d = 1; d * d <= count; ++d)
+        if (count % d == 0)
+            rows = d;
+    return rows;
+}
+
+// Splits C into a 2D grid of tiles, one per pool thread, each computed by the blocked
+// kernel on its own packed panels; tile edges fall on micro-tile boundaries
+template <typename T>
+static void gemmParallel(int n, int threads, T alpha, Operand<T> a, Operand<T> b, T* c, int ldc) {
+    const MicroKernel<T> kernel = microKernel<T>();
+    const int gridRows = tileRowsFor(threads);
+    const int gridCols = threads / gridRows;
+    const int rowsPerTile = ((n + gridRows - 1) / gridRows + kernel.mr - 1) / kernel.mr * kernel.mr;
+    const int colsPerTile = ((n + gridCols - 1) / gridCols + kernel.nr - 1) / kernel.nr * kernel.nr;
+
+    ThreadPool::parallelFor(gridRows * gridCols, [&](int tile) {
+        const int row = tile / gridCols * rowsPerTile;
+        const int col = tile % gridCols * colsPerTile;
+        if (row >= n || col >= n)
+            return;
+        const int rows = n - row < rowsPerTile ? n - row : rowsPerTile;
+        const int cols = n - col < colsPerTile ? n - col : colsPerTile;
+        gemmBlocked(rows, cols, n, alpha, a.block(row, 0), b.block(0, col),
+                    c + static_cast<std::ptrdiff_t>(row) * ldc + col, ldc);
+    });
+}
+
+// C = alpha * op(A) * op(B) + beta * C with the classical algorithm
+template <typename T>
+static void gemmClassical(int n, T alpha, Operand<T> a, Operand<T> b, T beta, T* c, int ldc) {
+    scaleRows(n, beta, c, ldc);
+    const int threads = ThreadPool::threadCount();
+    if (n <= DIRECT_LIMIT)
+        gemmDirect(n, alpha, a, b, c, ldc);
+    else if (n >= PARALLEL_LIMIT && threads > 1)
+        gemmParallel(n, threads, alpha, a, b, c, ldc);
+    else
+        gemmBlocked(n, n, n, alpha, a, b, c, ldc);
+}
+
+// Crossover used when none is set: MATRIX_STRASSEN (negative values turn Strassen off), else the built-in one
+static int defaultStrassenCrossover() {
+    if (const char* value = std::getenv("MATRIX_STRASSEN")) {
+        const int crossover = std::atoi(value);
+        return crossover > 0 ? crossover : 0;
+    }
+    return DEFAULT_STRASSEN_CROSSOVER;
+}
+
+// Crossover read from MATRIX_STRASSEN on first use
+static std::atomic<int>& crossoverSetting() {
+    static std::atomic<int> crossover(defaultStrassenCrossover());
+    return crossover;
+}
+
+void setStrassenCrossover(int n) {
+    crossoverSetting().store(n > 0 ? n : 0, std::memory_order_relaxed);
+}
+
+void resetStrassenCrossover() {
+    crossoverSetting().store(defaultStrassenCrossover(), std::memory_order_relaxed);
+}
+
+int strassenCrossover() {
+    return crossoverSetting().load(std::memory_order_relaxed);
+}
+
+// Integer products keep the classical algorithm: Strassen's operand sums could overflow
+// where the classical product does not
+template <typename T>
+static constexpr bool strassenEligible() {
+    return std::is_floating_point<T>::value || std::is_same<T, std::complex<double>>::value;
+}
+
+// Z = X + Y on h x h blocks
+template <typename T>
+static void addBlocks(int h, const T* x, int ldx, const T* y, int ldy, T* z, int ldz) {
+    for (int i = 0; i < h; ++i)
+        addRow(h, x + static_cast<std::ptrdiff_t>(i) * ldx, y + static_cast<std::ptrdiff_t>(i) * ldy,
+               z + static_cast<std::ptrdiff_t>(i) * ldz);
+}
+
+// Z = X - Y on h x h blocks
+template <typename T>
+static void subBlocks(int h, const T* x, int ldx, const T* y, int ldy, T* z, int ldz) {
+    for (int i = 0; i < h; ++i)
+        subRow(h, x + static_cast<std::ptrdiff_t>(i) * ldx, y + static_cast<std::ptrdiff_t>(i) * ldy,
+               z + static_cast<std::ptrdiff_t>(i) * ldz);
+}
+
+// C = op(A) * op(B) by Strassen-Winograd recursion (7 products, 15 additions per level),
+// scheduled with two h x h temporaries; odd sizes peel off the last row and column.
+// Sums of quadrants of a transposed operand are kept transposed too (X^T - Y^T = (X - Y)^T),
+// so the temporaries inherit the operand's trans flag and nothing is ever transposed.
+template <typename T>
+static void strassen(int n, Operand<T> a, Operand<T> b, T* c, int ldc, int crossover) {
+    if (n < crossover || n < 2) {
+        gemmClassical(n, T(1), a, b, T(0), c, ldc);
+        return;
+    }
+
+    if (n % 2 != 0) {
+        const int m = n - 1;
+        strassen(m, a, b, c, ldc, crossover);
+        // C11 += A12 * B21 (rank-one update), then the last column and row of C in full
+        for (int i = 0; i < m; ++i) {
+            T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+            const T aim = a.at(i, m);
+            for (int j = 0; j < m; ++j)
+                ci[j] += aim * b.at(m, j);
+            T dot = T(0);
+            for (int k = 0; k < n; ++k)
+                dot += a.at(i, k) * b.at(k, m);
+            ci[m] = dot;
+        }
+        T* cm = c + static_cast<std::ptrdiff_t>(m) * ldc;
+        for (int j = 0; j < n; ++j)
+            cm[j] = T(0);
+        for (int k = 0; k < n; ++k) {
+            const T amk = a.at(m, k);
+            for (int j = 0; j < n; ++j)
+                cm[j] += amk * b.at(k, j);
+        }
+        return;
+    }
+
+    const int h = n / 2;
+    const Operand<T> a11 = a.block(0, 0), a12 = a.block(0, h), a21 = a.block(h, 0), a22 = a.block(h, h);
+    const Operand<T> b11 = b.block(0, 0), b12 = b.block(0, h), b21 = b.block(h, 0), b22 = b.block(h, h);
+    const int lda = a.ld;
+    const int ldb = b.ld;
+    T* c11 = c;
+    T* c12 = c + h;
+    T* c21 = c + static_cast<std::ptrdiff_t>(h) * ldc;
+    T* c22 = c21 + h;
+
+    const std::size_t bytes = sizeof(T) * h * h;
+    T* x = static_cast<T*>(BufferPool::acquire(bytes));
+    T* y = static_cast<T*>(BufferPool::acquire(bytes));
+    const Operand<T> xs{x, h, a.trans};
+    const Operand<T> ys{y, h, b.trans};
+
+    subBlocks(h, a11.data, lda, a21.data, lda, x, h);  // S3 = A11 - A21
+    subBlocks(h, b22.data, ldb, b12.data, ldb, y, h);  // T3 = B22 - B12
+    strassen(h, xs, ys, c21, ldc, crossover);          // P7 = S3 * T3
+    addBlocks(h, a21.data, lda, a22.data, lda, x, h);  // S1 = A21 + A22
+    subBlocks(h, b12.data, ldb, b11.data, ldb, y, h);  // T1 = B12 - B11
+    strassen(h, xs, ys, c22, ldc, crossover);          // P5 = S1 * T1
+    subBlocks(h, x, h, a11.data, lda, x, h);           // S2 = S1 - A11
+    subBlocks(h, b22.data, ldb, y, h, y, h);           // T2 = B22 - T1
+    strassen(h, xs, ys, c12, ldc, crossover);          // P6 = S2 * T2
+    subBlocks(h, a12.data, lda, x, h, x, h);           // S4 = A12 - S2
+    strassen(h, xs, b22, c11, ldc, crossover);         // P3 = S4 * B22
+    strassen(h, a11, b11, x, h, crossover);            // P1 = A11 * B11 (x now holds a product)
+    addBlocks(h, x, h, c12, ldc, c12, ldc);            // U2 = P1 + P6
+    addBlocks(h, c12, ldc, c21, ldc, c21, ldc);        // U3 = U2 + P7
+    addBlocks(h, c12, ldc, c22, ldc, c12, ldc);        // U4 = U2 + P5
+    addBlocks(h, c21, ldc, c22, ldc, c22, ldc);        // C22 = U7 = U3 + P5
+    addBlocks(h, c12, ldc, c11, ldc, c12, ldc);        // C12 = U5 = U4 + P3
+    subBlocks(h, y, h, b21.data, ldb, y, h);           // T4 = T2 - B21
+    strassen(h, a22, ys, c11, ldc, crossover);         // P4 = A22 * T4
+    subBlocks(h, c21, ldc, c11, ldc, c21, ldc);        // C21 = U6 = U3 - P4
+    strassen(h, a12, b21, c11, ldc, crossover);        // P2 = A12 * B21
+    addBlocks(h, x, h, c11, ldc, c11, ldc);            // C11 = U1 = P1 + P2
+
+    BufferPool::release(y, bytes);
+    BufferPool::release(x, bytes);
+}
+
+// C = alpha * op(A) * op(B) + beta * C
+template <typename T>
+void gemm(Transpose transA, Transpose transB, int n, T alpha, const T* a, int lda, const T* b, int ldb, T beta,
+          T* c, int ldc) {
+    const Operand<T> opA{a, lda, transA == Transpose::Yes};
+    const Operand<T> opB{b, ldb, transB == Transpose::Yes};
+    const int crossover = strassenCrossover();
+    if (!strassenEligible<T>() || crossover == 0 || n < crossover) {
+        gemmClassical(n, alpha, opA, opB, beta, c, ldc);
+        return;
+    }
+    if (alpha == T(1) && beta == T(0)) {
+        strassen(n, opA, opB, c, ldc, crossover);
+        return;
+    }
+    // General alpha and beta: form the product aside, then fold it into C
+    const std::size_t bytes = sizeof(T) * n * n;
+    T* product = static_cast<T*>(BufferPool::acquire(bytes));
+    strassen(n, opA, opB, product, n, crossover);
+    scaleRows(n, beta, c, ldc);
+    for (int i = 0; i < n; ++i) {
+        const T* pi = product + static_cast<std::ptrdiff_t>(i) * n;
+        T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        for (int j = 0; j < n; ++j)
+            ci[j] += alpha * pi[j];
+    }
+    BufferPool::release(product, bytes);
+}
+
+// A and B rounded to float once; each output tile then sums float products of MIXED_DEPTH-deep
+// slices into double, so float rounding builds up over one slice rather than all of n
+void gemmMixed(int n, const double* a, int lda, const double* b, int ldb, double* c, int ldc) {
+    const std::size_t bytes = sizeof(float) * n * n;
+    float* af = static_cast<float*>(BufferPool::acquire(bytes));
+    float* bf = static_cast<float*>(BufferPool::acquire(bytes));
+    for (int i = 0; i < n; ++i) {
+        const double* ai = a + static_cast<std::ptrdiff_t>(i) * lda;
+        const double* bi = b + static_cast<std::ptrdiff_t>(i) * ldb;
+        float* afi = af + static_cast<std::ptrdiff_t>(i) * n;
+        float* bfi = bf + static_cast<std::ptrdiff_t>(i) * n;
+        for (int j = 0; j < n; ++j) {
+            afi[j] = static_cast<float>(ai[j]);
+            bfi[j] = static_cast<float>(bi[j]);
+        }
+    }
+
+    const MicroKernel<float> kernel = microKernel<float>();
+    const int threads = n >= PARALLEL_LIMIT ? ThreadPool::threadCount() : 1;
+    const int gridRows = tileRowsFor(threads);
+    const int gridCols = threads / gridRows;
+    const int rowsPerTile = ((n + gridRows - 1) / gridRows + kernel.mr - 1) / kernel.mr * kernel.mr;
+    const int colsPerTile = ((n + gridCols - 1) / gridCols + kernel.nr - 1) / kernel.nr * kernel.nr;
+
+    const auto computeTile = [&](int tile) {
+        const int row = tile / gridCols * rowsPerTile;
+        const int col = tile % gridCols * colsPerTile;
+        if (row >= n || col >= n)
+            return;
+        const int rows = n - row < rowsPerTile ? n - row : rowsPerTile;
+        const int cols = n - col < colsPerTile ? n - col : colsPerTile;
+        const std::size_t scratchBytes = sizeof(float) * rows * cols;
+        float* scratch = static_cast<float*>(BufferPool::acquire(scratchBytes));
+        for (int pc = 0; pc < n; pc += MIXED_DEPTH) {
+            const int kc = n - pc < MIXED_DEPTH ? n - pc : MIXED_DEPTH;
+            for (int i = 0; i < rows * cols; ++i)
+                scratch[i] = 0.0f;
+            const Operand<float> left{af + static_cast<std::ptrdiff_t>(row) * n + pc, n, false};
+            const Operand<float> right{bf + static_cast<std::ptrdiff_t>(pc) * n + col, n, false};
+            gemmBlocked(rows, cols, kc, 1.0f, left, right, scratch, cols);
+            for (int i = 0; i < rows; ++i) {
+                double* ci = c + static_cast<std::ptrdiff_t>(row + i) * ldc + col;
+                const float* si = scratch + static_cast<std::ptrdiff_t>(i) * cols;
+                for (int j = 0; j < cols; ++j)
+                    ci[j] = pc == 0 ? static_cast<double>(si[j]) : ci[j] + static_cast<double>(si[j]);
+            }
+        }
+        BufferPool::release(scratch, scratchBytes);
+    };
+
+    if (threads > 1) {
+        ThreadPool::parallelFor(gridRows * gridCols, computeTile);
+    } else {
+        computeTile(0);
+    }
+
+    BufferPool::release(bf, bytes);
+    BufferPool::release(af, bytes);
+}
+
+// Modular rows [first, last) of C with accumulator type Acc, wide enough for 2 * m^2:
+// i-k-j order streams rows of B into one row of accumulators
+template <typename Acc>
+static void gemmModRows(int first, int last, int n, const std::int64_t* a, int lda, const std::int64_t* b, int ldb,
+                        std::int64_t* c, int ldc, std::int64_t modulus, Acc* acc) {
+    const Acc m = static_cast<Acc>(modulus);
+    const Acc square = m * m;
+    for (int i = first; i < last; ++i) {
+        const std::int64_t* ai = a + static_cast<std::ptrdiff_t>(i) * lda;
+        for (int j = 0; j < n; ++j)
+            acc[j] = 0;
+        for (int k = 0; k < n; ++k) {
+            const Acc aik = static_cast<Acc>(ai[k]);
+            if (aik == 0)
+                continue;
+            const std::int64_t* bk = b + static_cast<std::ptrdiff_t>(k) * ldb;
+            for (int j = 0; j < n; ++j) {
+                const Acc sum = acc[j] + aik * static_cast<Acc>(bk[j]);
+                acc[j] = sum >= square ? sum - square : sum;
+            }
+        }
+        std::int64_t* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        for (int j = 0; j < n; ++j)
+            ci[j] = static_cast<std::int64_t>(acc[j] % m);
+    }
+}
+
+// Rows split into one contiguous band per thread, each with its own accumulator row
+template <typename Acc>
+static void gemmModBands(int n, const std::int64_t* a, int lda, const std::int64_t* b, int ldb, std::int64_t* c,
+                         int ldc, std::int64_t modulus) {
+    const int threads = n >= PARALLEL_LIMIT ? ThreadPool::threadCount() : 1;
+    const int rowsPerBand = (n + threads - 1) / threads;
+    const auto computeBand = [&](int band) {
+        const int first = band * rowsPerBand;
+        const int last = n - first < rowsPerBand ? n : first + rowsPerBand;
+        if (first >= n)
+            return;
+        const std::size_t bytes = sizeof(Acc) * n;
+        Acc* acc = static_cast<Acc*>(BufferPool::acquire(bytes));
+        gemmModRows(first, last, n, a, lda, b, ldb, c, ldc, modulus, acc);
+        BufferPool::release(acc, bytes);
+    };
+    if (threads > 1) {
+        ThreadPool::parallelFor(threads, computeBand);
+    } else {
+        computeBand(0);
+    }
+}
+
+void gemmMod(int n, const std::int64_t* a, int lda, const std::int64_t* b, int ldb, std::int64_t* c, int ldc,
+             std::int64_t modulus) {
+    if (modulus <= (std::int64_t(1) << 31))
+        gemmModBands<std::uint64_t>(n, a, lda, b, ldb, c, ldc, modulus); // 2 * m^2 <= 2^63
+    else
+        gemmModBands<unsigned __int128>(n, a, lda, b, ldb, c, ldc, modulus); // 2 * m^2 < 2^127
+}
+
+// Whether element (i, j) lies in the triangle
+static bool inTriangle(Triangle uplo, int i, int j) {
+    return uplo == Triangle::Lower ? j <= i : j >= i;
+}
+
+// The triangle of C = alpha * A * A^T + beta * C: square tiles on one side of the diagonal,
+// each a blocked product of two row panels of A; diagonal tiles go through a scratch
+// tile so the other triangle is never written
+template <typename T>
+void syrk(Triangle uplo, int n, T alpha, const T* a, int lda, T beta, T* c, int ldc) {
+    for (int i = 0; i < n; ++i) {
+        T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        const int first = uplo == Triangle::Lower ? 0 : i;
+        const int last = uplo == Triangle::Lower ? i + 1 : n;
+        for (int j = first; j < last; ++j)
+            ci[j] = beta == T(0) ? T(0) : ci[j] * beta;
+    }
+
+    if (n <= DIRECT_LIMIT) {
+        for (int i = 0; i < n; ++i) {
+            const T* ai = a + static_cast<std::ptrdiff_t>(i) * lda;
+            T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+            for (int j = 0; j < n; ++j) {
+                if (!inTriangle(uplo, i, j))
+                    continue;
+                const T* aj = a + static_cast<std::ptrdiff_t>(j) * lda;
+                T dot = T(0);
+                for (int k = 0; k < n; ++k)
+                    dot += ai[k] * aj[k];
+                ci[j] += alpha * dot;
+            }
+        }
+        return;
+    }
+
+    const int blocks = (n + SYRK_BLOCK - 1) / SYRK_BLOCK;
+    const auto computeTile = [&](int tile) {
+        int outer = 0; // Tiles are numbered row by row through the lower triangle of the tile grid
+        while (tile > outer) {
+            tile -= outer + 1;
+            ++outer;
+        }
+        const int bi = uplo == Triangle::Lower ? outer : tile;
+        const int bj = uplo == Triangle::Lower ? tile : outer;
+        const int row = bi * SYRK_BLOCK;
+        const int col = bj * SYRK_BLOCK;
+        const int rows = n - row < SYRK_BLOCK ? n - row : SYRK_BLOCK;
+        const int cols = n - col < SYRK_BLOCK ? n - col : SYRK_BLOCK;
+        const Operand<T> left{a + static_cast<std::ptrdiff_t>(row) * lda, lda, false};
+        const Operand<T> right{a + static_cast<std::ptrdiff_t>(col) * lda, lda, true};
+        T* target = c + static_cast<std::ptrdiff_t>(row) * ldc + col;
+        if (bi != bj) {
+            gemmBlocked(rows, cols, n, alpha, left, right, target, ldc);
+            return;
+        }
+        const std::size_t bytes = sizeof(T) * rows * cols;
+        T* scratch = static_cast<T*>(BufferPool::acquire(bytes));
+        for (int i = 0; i < rows * cols; ++i)
+            scratch[i] = T(0);
+        gemmBlocked(rows, cols, n, alpha, left, right, scratch, cols);
+        for (int i = 0; i < rows; ++i)
+            for (int j = 0; j < cols; ++j)
+                if (inTriangle(uplo, i, j))
+                    target[static_cast<std::ptrdiff_t>(i) * ldc + j] += scratch[i * cols + j];
+        BufferPool::release(scratch, bytes);
+    };
+
+    const int tiles = blocks * (blocks + 1) / 2;
+    if (n >= PARALLEL_LIMIT && ThreadPool::threadCount() > 1) {
+        ThreadPool::parallelFor(tiles, computeTile);
+    } else {
+        for (int tile = 0; tile < tiles; ++tile)
+            computeTile(tile);
+    }
+}
+
+// Element types compiled into the library
+#define OPERATORS_INSTANTIATE_GEMM(T)                                                                  \
+    template GemmBlocking gemmBlocking<T>();                                                           \
+    template void setGemmBlocking<T>(GemmBlocking);                                                    \
+    template void gemm<T>(Transpose, Transpose, int, T, const T*, int, const T*, int, T, T*, int);     \
+    template void syrk<T>(Triangle, int, T, const T*, int, T, T*, int);
+
+OPERATORS_INSTANTIATE_GEMM(float)
+OPERATORS_INSTANTIATE_GEMM(double)
+OPERATORS_INSTANTIATE_GEMM(std::int64_t)
+OPERATORS_INSTANTIATE_GEMM(std::complex<double>)
+
+#undef OPERATORS_INSTANTIATE_GEMM
+
+}
+}
@@ -0,0 +1,190 @@
+// Author: realyoavperetz@gmail.com
+
+#include "SimdKernels.hpp"
+
+#ifdef OPERATORS_X86_KERNELS
+
+#pragma GCC target("avx2,fma")
+#include <immintrin.h>
+#include <cstddef>
+
+namespace operators {
+namespace kernels {
+namespace avx2 {
+
+// 6 x 8 double tile: twelve 4-wide accumulators, leaving room for B and the broadcast
+static void gemmDouble(int kc, const double* a, const double* b, double* c, int ldc) {
+    __m256d acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+    for (int p = 0; p < kc; ++p) {
+        const __m256d b0 = _mm256_loadu_pd(b);
+        const __m256d b1 = _mm256_loadu_pd(b + 4);
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            const __m256d ai = _mm256_broadcast_sd(a + i);
+            acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+        }
+        a += 6;
+        b += 8;
+    }
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) {
+        double* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        _mm256_storeu_pd(ci, _mm256_add_pd(_mm256_loadu_pd(ci), acc[i][0]));
+        _mm256_storeu_pd(ci + 4, _mm256_add_pd(_mm256_loadu_pd(ci + 4), acc[i][1]));
+    }
+}
+
+// 6 x 16 float tile: twelve 8-wide accumulators
+static void gemmFloat(int kc, const float* a, const float* b, float* c, int ldc) {
+    __m256 acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+    for (int p = 0; p < kc; ++p) {
+        const __m256 b0 = _mm256_loadu_ps(b);
+        const __m256 b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            const __m256 ai = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) {
+        float* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        _mm256_storeu_ps(ci, _mm256_add_ps(_mm256_loadu_ps(ci), acc[i][0]));
+        _mm256_storeu_ps(ci + 8, _mm256_add_ps(_mm256_loadu_ps(ci + 8), acc[i][1]));
+    }
+}
+
+static void addDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(out + j, _mm256_add_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] + b[j];
+}
+
+static void subDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(out + j, _mm256_sub_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] - b[j];
+}
+
+static void mulDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(out + j, _mm256_mul_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] * b[j];
+}
+
+static void mulAddDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(out + j, _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j), _mm256_loadu_pd(out + j)));
+    for (; j < n; ++j)
+        out[j] += a[j] * b[j];
+}
+
+static void scaleDouble(int n, const double* a, double factor, double* out) {
+    const __m256d s = _mm256_set1_pd(factor);
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(out + j, _mm256_mul_pd(_mm256_loadu_pd(a + j), s));
+    for (; j < n; ++j)
+        out[j] = a[j] * factor;
+}
+
+static double sumDouble(int n, const double* a) {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + j));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + j + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(s0, s1));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; j < n; ++j)
+        total += a[j];
+    return total;
+}
+
+static void addFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(out + j, _mm256_add_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] + b[j];
+}
+
+static void subFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(out + j, _mm256_sub_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] - b[j];
+}
+
+static void mulFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(out + j, _mm256_mul_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] * b[j];
+}
+
+static void mulAddFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(out + j, _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(b + j), _mm256_loadu_ps(out + j)));
+    for (; j < n; ++j)
+        out[j] += a[j] * b[j];
+}
+
+static void scaleFloat(int n, const float* a, float factor, float* out) {
+    const __m256 s = _mm256_set1_ps(factor);
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(out + j, _mm256_mul_ps(_mm256_loadu_ps(a + j), s));
+    for (; j < n; ++j)
+        out[j] = a[j] * factor;
+}
+
+static float sumFloat(int n, const float* a) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        s0 = _mm256_add_ps(s0, _mm256_loadu_ps(a + j));
+        s1 = _mm256_add_ps(s1, _mm256_loadu_ps(a + j + 8));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(s0, s1));
+    float total = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for (; j < n; ++j)
+        total += a[j];
+    return total;
+}
+
+const IsaKernels<double> doubleKernels = {{6, 8, gemmDouble}, addDouble,   subDouble, mulDouble,
+                                          mulAddDouble,       scaleDouble, sumDouble};
+const IsaKernels<float> floatKernels = {{6, 16, gemmFloat}, addFloat,   subFloat, mulFloat,
+                                        mulAddFloat,        scaleFloat, sumFloat};
+
+}
+}
+}
+
+#endif
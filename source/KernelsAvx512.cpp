@@ -0,0 +1,225 @@
+// Author: realyoavperetz@gmail.com
+
+#include "SimdKernels.hpp"
+
+#ifdef OPERATORS_X86_KERNELS
+
+#pragma GCC target("avx512f,avx2,fma")
+#include <immintrin.h>
+#include <cstddef>
+
+namespace operators {
+namespace kernels {
+namespace avx512 {
+
+// 8 x 16 double tile: sixteen 8-wide accumulators out of the 32 registers
+static void gemmDouble(int kc, const double* a, const double* b, double* c, int ldc) {
+    __m512d acc[8][2];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i)
+        acc[i][0] = acc[i][1] = _mm512_setzero_pd();
+    for (int p = 0; p < kc; ++p) {
+        const __m512d b0 = _mm512_loadu_pd(b);
+        const __m512d b1 = _mm512_loadu_pd(b + 8);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            const __m512d ai = _mm512_set1_pd(a[i]);
+            acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+        }
+        a += 8;
+        b += 16;
+    }
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) {
+        double* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        _mm512_storeu_pd(ci, _mm512_add_pd(_mm512_loadu_pd(ci), acc[i][0]));
+        _mm512_storeu_pd(ci + 8, _mm512_add_pd(_mm512_loadu_pd(ci + 8), acc[i][1]));
+    }
+}
+
+// 8 x 32 float tile: sixteen 16-wide accumulators
+static void gemmFloat(int kc, const float* a, const float* b, float* c, int ldc) {
+    __m512 acc[8][2];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i)
+        acc[i][0] = acc[i][1] = _mm512_setzero_ps();
+    for (int p = 0; p < kc; ++p) {
+        const __m512 b0 = _mm512_loadu_ps(b);
+        const __m512 b1 = _mm512_loadu_ps(b + 16);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            const __m512 ai = _mm512_set1_ps(a[i]);
+            acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+        }
+        a += 8;
+        b += 32;
+    }
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) {
+        float* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        _mm512_storeu_ps(ci, _mm512_add_ps(_mm512_loadu_ps(ci), acc[i][0]));
+        _mm512_storeu_ps(ci + 16, _mm512_add_ps(_mm512_loadu_ps(ci + 16), acc[i][1]));
+    }
+}
+
+// Lanes still to process at j, as a load/store mask
+static __mmask8 tailMask8(int remaining) {
+    return static_cast<__mmask8>((1u << remaining) - 1);
+}
+
+static __mmask16 tailMask16(int remaining) {
+    return static_cast<__mmask16>((1u << remaining) - 1);
+}
+
+// Row kernels finish with one masked iteration instead of a scalar tail
+static void addDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(out + j, _mm512_add_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j)));
+    if (j < n) {
+        const __mmask8 m = tailMask8(n - j);
+        _mm512_mask_storeu_pd(out + j, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, a + j), _mm512_maskz_loadu_pd(m, b + j)));
+    }
+}
+
+static void subDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(out + j, _mm512_sub_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j)));
+    if (j < n) {
+        const __mmask8 m = tailMask8(n - j);
+        _mm512_mask_storeu_pd(out + j, m, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, a + j), _mm512_maskz_loadu_pd(m, b + j)));
+    }
+}
+
+static void mulDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(out + j, _mm512_mul_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j)));
+    if (j < n) {
+        const __mmask8 m = tailMask8(n - j);
+        _mm512_mask_storeu_pd(out + j, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, a + j), _mm512_maskz_loadu_pd(m, b + j)));
+    }
+}
+
+static void mulAddDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(out + j, _mm512_fmadd_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j), _mm512_loadu_pd(out + j)));
+    if (j < n) {
+        const __mmask8 m = tailMask8(n - j);
+        _mm512_mask_storeu_pd(out + j, m,
+                              _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + j), _mm512_maskz_loadu_pd(m, b + j),
+                                              _mm512_maskz_loadu_pd(m, out + j)));
+    }
+}
+
+static void scaleDouble(int n, const double* a, double factor, double* out) {
+    const __m512d s = _mm512_set1_pd(factor);
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(out + j, _mm512_mul_pd(_mm512_loadu_pd(a + j), s));
+    if (j < n) {
+        const __mmask8 m = tailMask8(n - j);
+        _mm512_mask_storeu_pd(out + j, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, a + j), s));
+    }
+}
+
+static double sumDouble(int n, const double* a) {
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(a + j));
+        s1 = _mm512_add_pd(s1, _mm512_loadu_pd(a + j + 8));
+    }
+    for (; j < n; j += 8)
+        s0 = _mm512_add_pd(s0, _mm512_maskz_loadu_pd(tailMask8(n - j < 8 ? n - j : 8), a + j));
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(s0, s1));
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+static void addFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(out + j, _mm512_add_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(b + j)));
+    if (j < n) {
+        const __mmask16 m = tailMask16(n - j);
+        _mm512_mask_storeu_ps(out + j, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, a + j), _mm512_maskz_loadu_ps(m, b + j)));
+    }
+}
+
+static void subFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(out + j, _mm512_sub_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(b + j)));
+    if (j < n) {
+        const __mmask16 m = tailMask16(n - j);
+        _mm512_mask_storeu_ps(out + j, m, _mm512_sub_ps(_mm512_maskz_loadu_ps(m, a + j), _mm512_maskz_loadu_ps(m, b + j)));
+    }
+}
+
+static void mulFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(out + j, _mm512_mul_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(b + j)));
+    if (j < n) {
+        const __mmask16 m = tailMask16(n - j);
+        _mm512_mask_storeu_ps(out + j, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a + j), _mm512_maskz_loadu_ps(m, b + j)));
+    }
+}
+
+static void mulAddFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(out + j, _mm512_fmadd_ps(_mm512_loadu_ps(a + j), _mm512_loadu_ps(b + j), _mm512_loadu_ps(out + j)));
+    if (j < n) {
+        const __mmask16 m = tailMask16(n - j);
+        _mm512_mask_storeu_ps(out + j, m,
+                              _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + j), _mm512_maskz_loadu_ps(m, b + j),
+                                              _mm512_maskz_loadu_ps(m, out + j)));
+    }
+}
+
+static void scaleFloat(int n, const float* a, float factor, float* out) {
+    const __m512 s = _mm512_set1_ps(factor);
+    int j = 0;
+    for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(out + j, _mm512_mul_ps(_mm512_loadu_ps(a + j), s));
+    if (j < n) {
+        const __mmask16 m = tailMask16(n - j);
+        _mm512_mask_storeu_ps(out + j, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a + j), s));
+    }
+}
+
+static float sumFloat(int n, const float* a) {
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    int j = 0;
+    for (; j + 32 <= n; j += 32) {
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(a + j));
+        s1 = _mm512_add_ps(s1, _mm512_loadu_ps(a + j + 16));
+    }
+    for (; j < n; j += 16)
+        s0 = _mm512_add_ps(s0, _mm512_maskz_loadu_ps(tailMask16(n - j < 16 ? n - j : 16), a + j));
+    float lanes[16];
+    _mm512_storeu_ps(lanes, _mm512_add_ps(s0, s1));
+    float total = 0;
+    for (int i = 0; i < 16; i += 2)
+        total += lanes[i] + lanes[i + 1];
+    return total;
+}
+
+const IsaKernels<double> doubleKernels = {{8, 16, gemmDouble}, addDouble,   subDouble, mulDouble,
+                                          mulAddDouble,        scaleDouble, sumDouble};
+const IsaKernels<float> floatKernels = {{8, 32, gemmFloat}, addFloat,   subFloat, mulFloat,
+                                        mulAddFloat,        scaleFloat, sumFloat};
+
+}
+}
+}
+
+#endif
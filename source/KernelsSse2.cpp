@@ -0,0 +1,190 @@
+// Author: realyoavperetz@gmail.com
+
+#include "SimdKernels.hpp"
+
+#ifdef OPERATORS_X86_KERNELS
+
+#pragma GCC target("sse2")
+#include <immintrin.h>
+#include <cstddef>
+
+namespace operators {
+namespace kernels {
+namespace sse2 {
+
+// 4 x 4 double tile: eight 2-wide accumulators
+static void gemmDouble(int kc, const double* a, const double* b, double* c, int ldc) {
+    __m128d acc[4][2];
+#pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i)
+        acc[i][0] = acc[i][1] = _mm_setzero_pd();
+    for (int p = 0; p < kc; ++p) {
+        const __m128d b0 = _mm_loadu_pd(b);
+        const __m128d b1 = _mm_loadu_pd(b + 2);
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            const __m128d ai = _mm_set1_pd(a[i]);
+            acc[i][0] = _mm_add_pd(acc[i][0], _mm_mul_pd(ai, b0));
+            acc[i][1] = _mm_add_pd(acc[i][1], _mm_mul_pd(ai, b1));
+        }
+        a += 4;
+        b += 4;
+    }
+#pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) {
+        double* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        _mm_storeu_pd(ci, _mm_add_pd(_mm_loadu_pd(ci), acc[i][0]));
+        _mm_storeu_pd(ci + 2, _mm_add_pd(_mm_loadu_pd(ci + 2), acc[i][1]));
+    }
+}
+
+// 4 x 8 float tile: eight 4-wide accumulators
+static void gemmFloat(int kc, const float* a, const float* b, float* c, int ldc) {
+    __m128 acc[4][2];
+#pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i)
+        acc[i][0] = acc[i][1] = _mm_setzero_ps();
+    for (int p = 0; p < kc; ++p) {
+        const __m128 b0 = _mm_loadu_ps(b);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+#pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            const __m128 ai = _mm_set1_ps(a[i]);
+            acc[i][0] = _mm_add_ps(acc[i][0], _mm_mul_ps(ai, b0));
+            acc[i][1] = _mm_add_ps(acc[i][1], _mm_mul_ps(ai, b1));
+        }
+        a += 4;
+        b += 8;
+    }
+#pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) {
+        float* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+        _mm_storeu_ps(ci, _mm_add_ps(_mm_loadu_ps(ci), acc[i][0]));
+        _mm_storeu_ps(ci + 4, _mm_add_ps(_mm_loadu_ps(ci + 4), acc[i][1]));
+    }
+}
+
+static void addDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(out + j, _mm_add_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] + b[j];
+}
+
+static void subDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(out + j, _mm_sub_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] - b[j];
+}
+
+static void mulDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(out + j, _mm_mul_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] * b[j];
+}
+
+static void mulAddDouble(int n, const double* a, const double* b, double* out) {
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(out + j, _mm_add_pd(_mm_loadu_pd(out + j), _mm_mul_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j))));
+    for (; j < n; ++j)
+        out[j] += a[j] * b[j];
+}
+
+static void scaleDouble(int n, const double* a, double factor, double* out) {
+    const __m128d s = _mm_set1_pd(factor);
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(out + j, _mm_mul_pd(_mm_loadu_pd(a + j), s));
+    for (; j < n; ++j)
+        out[j] = a[j] * factor;
+}
+
+static double sumDouble(int n, const double* a) {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(a + j));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(a + j + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(s0, s1));
+    double total = lanes[0] + lanes[1];
+    for (; j < n; ++j)
+        total += a[j];
+    return total;
+}
+
+static void addFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm_storeu_ps(out + j, _mm_add_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] + b[j];
+}
+
+static void subFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm_storeu_ps(out + j, _mm_sub_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] - b[j];
+}
+
+static void mulFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm_storeu_ps(out + j, _mm_mul_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(b + j)));
+    for (; j < n; ++j)
+        out[j] = a[j] * b[j];
+}
+
+static void mulAddFloat(int n, const float* a, const float* b, float* out) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm_storeu_ps(out + j, _mm_add_ps(_mm_loadu_ps(out + j), _mm_mul_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(b + j))));
+    for (; j < n; ++j)
+        out[j] += a[j] * b[j];
+}
+
+static void scaleFloat(int n, const float* a, float factor, float* out) {
+    const __m128 s = _mm_set1_ps(factor);
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm_storeu_ps(out + j, _mm_mul_ps(_mm_loadu_ps(a + j), s));
+    for (; j < n; ++j)
+        out[j] = a[j] * factor;
+}
+
+static float sumFloat(int n, const float* a) {
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        s0 = _mm_add_ps(s0, _mm_loadu_ps(a + j));
+        s1 = _mm_add_ps(s1, _mm_loadu_ps(a + j + 4));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(s0, s1));
+    float total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; j < n; ++j)
+        total += a[j];
+    return total;
+}
+
+const IsaKernels<double> doubleKernels = {{4, 4, gemmDouble}, addDouble,   subDouble, mulDouble,
+                                          mulAddDouble,       scaleDouble, sumDouble};
+const IsaKernels<float> floatKernels = {{4, 8, gemmFloat}, addFloat,   subFloat, mulFloat,
+                                        mulAddFloat,       scaleFloat, sumFloat};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,201 @@
+// Author: realyoavperetz@gmail.com
+
+#include "LinearRecurrence.hpp"
+#include <complex>
+#include <stdexcept>
+
+namespace operators {
+
+// Ring operations of the element type itself
+template <typename T>
+struct PlainRing {
+    T reduce(T value) const { return value; }
+    T add(T x, T y) const { return x + y; }
+    T mul(T x, T y) const { return x * y; }
+};
+
+// Integers modulo m, products through 128 bits
+struct ModularRing {
+    std::int64_t modulus;
+
+    std::int64_t reduce(std::int64_t value) const {
+        const std::int64_t r = value % modulus;
+        return r < 0 ? r + modulus : r;
+    }
+    std::int64_t add(std::int64_t x, std::int64_t y) const {
+        const std::int64_t sum = x + (y - modulus); // No overflow for x, y in [0, m)
+        return sum < 0 ? sum + modulus : sum;
+    }
+    std::int64_t mul(std::int64_t x, std::int64_t y) const {
+        return static_cast<std::int64_t>(static_cast<unsigned __int128>(x) * static_cast<std::uint64_t>(y) %
+                                         static_cast<std::uint64_t>(modulus));
+    }
+};
+
+// Folds the coefficients of x^(2k-2) .. x^k of poly back below x^k with
+// x^k = c[0] x^(k-1) + ... + c[k-1], from the top down
+template <typename T, typename Ring>
+static void reduceModCharacteristic(std::vector<T>& poly, const std::vector<T>& c, const Ring& ring) {
+    const int k = static_cast<int>(c.size());
+    for (int d = static_cast<int>(poly.size()) - 1; d >= k; --d) {
+        const T top = poly[d];
+        for (int m = 0; m < k; ++m)
+            poly[d - 1 - m] = ring.add(poly[d - 1 - m], ring.mul(top, c[m]));
+    }
+    poly.resize(k);
+}
+
+// x^n mod the characteristic polynomial, as k coefficients of x^0 .. x^(k-1): square for every
+// bit of n from the top, multiplying by x (a shift) for the set ones
+template <typename T, typename Ring>
+static std::vector<T> powerOfX(const std::vector<T>& c, std::int64_t n, const Ring& ring) {
+    const int k = static_cast<int>(c.size());
+    std::vector<T> result(k, T(0)), square(2 * k - 1);
+    result[0] = ring.reduce(T(1)); // x^0, then x^(prefix of n) after each bit
+    int bit = 62;
+    while (bit >= 0 && !((n >> bit) & 1))
+        --bit;
+    for (; bit >= 0; --bit) {
+        square.assign(2 * k - 1, T(0));
+        for (int s = 0; s < k; ++s)
+            for (int t = 0; t < k; ++t)
+                square[s + t] = ring.add(square[s + t], ring.mul(result[s], result[t]));
+        reduceModCharacteristic(square, c, ring);
+        result.swap(square);
+        if ((n >> bit) & 1) {
+            result.insert(result.begin(), T(0));
+            reduceModCharacteristic(result, c, ring);
+        }
+    }
+    return result;
+}
+
+template <typename T>
+static void checkRecurrence(const std::vector<T>& coefficients, const std::vector<T>& initial, std::int64_t n) {
+    if (coefficients.empty()) {
+        throw std::invalid_argument("Recurrence needs at least one coefficient");
+    }
+    if (initial.size() != coefficients.size()) {
+        throw std::invalid_argument("Recurrence needs one initial term per coefficient");
+    }
+    if (n < 0) {
+        throw std::invalid_argument("Term index must not be negative");
+    }
+}
+
+// a(n) = sum of r[t] a(t) for x^n = sum of r[t] x^t modulo the characteristic polynomial
+template <typename T, typename Ring>
+static T termOf(const std::vector<T>& c, const std::vector<T>& initial, std::int64_t n, const Ring& ring) {
+    const std::vector<T> r = powerOfX(c, n, ring);
+    T term = T(0);
+    for (std::size_t t = 0; t < c.size(); ++t)
+        term = ring.add(term, ring.mul(r[t], initial[t]));
+    return term;
+}
+
+template <typename T>
+T recurrenceTerm(const std::vector<T>& coefficients, const std::vector<T>& initial, std::int64_t n) {
+    checkRecurrence(coefficients, initial, n);
+    return termOf(coefficients, initial, n, PlainRing<T>());
+}
+
+std::int64_t recurrenceTermMod(const std::vector<std::int64_t>& coefficients, const std::vector<std::int64_t>& initial,
+                               std::int64_t n, std::int64_t modulus) {
+    checkRecurrence(coefficients, initial, n);
+    if (modulus <= 0) {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+    const ModularRing ring{modulus};
+    std::vector<std::int64_t> c(coefficients), a(initial);
+    for (std::size_t t = 0; t < c.size(); ++t) {
+        c[t] = ring.reduce(c[t]);
+        a[t] = ring.reduce(a[t]);
+    }
+    return termOf(c, a, n, ring);
+}
+
+template <typename T>
+bool companionCoefficients(const BasicSquareMat<T>& a, std::vector<T>& coefficients) {
+    const int k = a.getSize();
+    for (int i = 1; i < k; ++i)
+        for (int j = 0; j < k; ++j)
+            if (a(i, j) != (j == i - 1 ? T(1) : T(0)))
+                return false;
+    coefficients.assign(k, T(0));
+    for (int j = 0; j < k; ++j)
+        coefficients[j] = a(0, j);
+    return true;
+}
+
+// Element (i, j) of C^n for the companion matrix C of c: by Cayley-Hamilton C^n = sum of
+// r[t] C^t, and the columns C^t e_j for t < k follow from one sparse companion step each, O(k^2)
+template <typename T, typename Ring>
+static T companionElement(const std::vector<T>& c, std::int64_t n, int i, int j, const Ring& ring) {
+    const int k = static_cast<int>(c.size());
+    const std::vector<T> r = powerOfX(c, n, ring);
+    std::vector<T> column(k, T(0)), next(k);
+    column[j] = ring.reduce(T(1)); // C^0 e_j
+    T element = T(0);
+    for (int t = 0; t < k; ++t) {
+        element = ring.add(element, ring.mul(r[t], column[i]));
+        T first = T(0);
+        for (int m = 0; m < k; ++m)
+            first = ring.add(first, ring.mul(c[m], column[m]));
+        next[0] = first;
+        for (int m = 1; m < k; ++m)
+            next[m] = column[m - 1];
+        column.swap(next);
+    }
+    return element;
+}
+
+template <typename T>
+static void checkElement(const BasicSquareMat<T>& a, int i, int j) {
+    if (i < 0 || i >= a.getSize() || j < 0 || j >= a.getSize()) {
+        throw std::out_of_range("Index out of range");
+    }
+}
+
+template <typename T>
+T powerElement(const BasicSquareMat<T>& a, int power, int i, int j) {
+    checkElement(a, i, j);
+    if (power < 0) {
+        throw std::invalid_argument("Negative powers are not supported");
+    }
+    std::vector<T> c;
+    if (!companionCoefficients(a, c))
+        return (a ^ power)(i, j);
+    return companionElement(c, power, i, j, PlainRing<T>());
+}
+
+std::int64_t powModElement(const IntSquareMat& a, std::int64_t power, std::int64_t modulus, int i, int j) {
+    checkElement(a, i, j);
+    if (power < 0) {
+        throw std::invalid_argument("Negative powers are not supported");
+    }
+    if (modulus <= 0) {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+    std::vector<std::int64_t> c;
+    if (!companionCoefficients(a, c))
+        return powMod(a, power, modulus)(i, j);
+    const ModularRing ring{modulus};
+    for (std::int64_t& value : c)
+        value = ring.reduce(value);
+    return companionElement(c, power, i, j, ring);
+}
+
+// Element types compiled into the library
+#define OPERATORS_INSTANTIATE_RECURRENCE(T)                                                        \
+    template T recurrenceTerm<T>(const std::vector<T>&, const std::vector<T>&, std::int64_t);     \
+    template bool companionCoefficients<T>(const BasicSquareMat<T>&, std::vector<T>&);            \
+    template T powerElement<T>(const BasicSquareMat<T>&, int, int, int);
+
+OPERATORS_INSTANTIATE_RECURRENCE(float)
+OPERATORS_INSTANTIATE_RECURRENCE(double)
+OPERATORS_INSTANTIATE_RECURRENCE(std::int64_t)
+OPERATORS_INSTANTIATE_RECURRENCE(std::complex<double>)
+
+#undef OPERATORS_INSTANTIATE_RECURRENCE
+
+}
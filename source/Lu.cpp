@@ -0,0 +1,97 @@
+// Author: realyoavperetz@gmail.com
+
+#include "Lu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+namespace operators {
+namespace kernels {
+
+// Right-looking elimination: pick the largest pivot in column k, swap it up, then subtract
+// multiples of row k from the rows below (contiguous row updates the compiler vectorizes).
+// Rounding rarely leaves an exact zero pivot in a singular matrix, so pivots are compared
+// with n * epsilon * max|A| instead
+template <typename T>
+bool luFactor(int n, T* a, int lda, int* pivots) {
+    using Real = decltype(std::abs(T()));
+    Real largest = 0;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            largest = std::max(largest, static_cast<Real>(std::abs(a[static_cast<std::ptrdiff_t>(i) * lda + j])));
+    const Real tolerance = n * std::numeric_limits<Real>::epsilon() * largest;
+    for (int k = 0; k < n; ++k) {
+        int pivot = k;
+        for (int i = k + 1; i < n; ++i)
+            if (std::abs(a[static_cast<std::ptrdiff_t>(i) * lda + k]) >
+                std::abs(a[static_cast<std::ptrdiff_t>(pivot) * lda + k]))
+                pivot = i;
+        pivots[k] = pivot;
+        T* ak = a + static_cast<std::ptrdiff_t>(k) * lda;
+        if (pivot != k) {
+            T* ap = a + static_cast<std::ptrdiff_t>(pivot) * lda;
+            for (int j = 0; j < n; ++j)
+                std::swap(ak[j], ap[j]);
+        }
+        if (std::abs(ak[k]) <= tolerance)
+            return false;
+        for (int i = k + 1; i < n; ++i) {
+            T* ai = a + static_cast<std::ptrdiff_t>(i) * lda;
+            const T factor = ai[k] / ak[k];
+            ai[k] = factor;
+            for (int j = k + 1; j < n; ++j)
+                ai[j] -= factor * ak[j];
+        }
+    }
+    return true;
+}
+
+// Row swaps, then forward substitution with L and back substitution with U, a whole row of B at a time
+template <typename T>
+void luSolve(int n, const T* lu, int ldlu, const int* pivots, int nrhs, T* b, int ldb) {
+    for (int k = 0; k < n; ++k) {
+        if (pivots[k] == k)
+            continue;
+        T* bk = b + static_cast<std::ptrdiff_t>(k) * ldb;
+        T* bp = b + static_cast<std::ptrdiff_t>(pivots[k]) * ldb;
+        for (int j = 0; j < nrhs; ++j)
+            std::swap(bk[j], bp[j]);
+    }
+    for (int i = 1; i < n; ++i) {
+        const T* li = lu + static_cast<std::ptrdiff_t>(i) * ldlu;
+        T* bi = b + static_cast<std::ptrdiff_t>(i) * ldb;
+        for (int k = 0; k < i; ++k) {
+            const T* bk = b + static_cast<std::ptrdiff_t>(k) * ldb;
+            for (int j = 0; j < nrhs; ++j)
+                bi[j] -= li[k] * bk[j];
+        }
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        const T* ui = lu + static_cast<std::ptrdiff_t>(i) * ldlu;
+        T* bi = b + static_cast<std::ptrdiff_t>(i) * ldb;
+        for (int k = i + 1; k < n; ++k) {
+            const T* bk = b + static_cast<std::ptrdiff_t>(k) * ldb;
+            for (int j = 0; j < nrhs; ++j)
+                bi[j] -= ui[k] * bk[j];
+        }
+        for (int j = 0; j < nrhs; ++j)
+            bi[j] /= ui[i];
+    }
+}
+
+// Element types compiled into the library; integer matrices have no LU over their own type
+#define OPERATORS_INSTANTIATE_LU(T)                                                \
+    template bool luFactor<T>(int, T*, int, int*);                                 \
+    template void luSolve<T>(int, const T*, int, const int*, int, T*, int);
+
+OPERATORS_INSTANTIATE_LU(float)
+OPERATORS_INSTANTIATE_LU(double)
+OPERATORS_INSTANTIATE_LU(std::complex<double>)
+
+#undef OPERATORS_INSTANTIATE_LU
+
+}
+}
@@ -0,0 +1,99 @@
+// Author: realyoavperetz@gmail.com
+
+#include "MatrixArena.hpp"
+#include <new>
+
+namespace operators {
+
+// Innermost open scope of each thread
+static thread_local MatrixArena* activeArena = nullptr;
+
+// Blocks keep their header in the first cache line so the payload stays aligned
+struct MatrixArena::Block {
+    Block* next;
+    std::size_t capacity;
+
+    char* payload() { return reinterpret_cast<char*>(this) + ALIGNMENT; }
+};
+
+static_assert(sizeof(void*) + sizeof(std::size_t) <= MatrixArena::ALIGNMENT,
+              "Block header must fit in one alignment unit");
+
+// Round a request up to whole alignment units
+static std::size_t roundUp(std::size_t bytes) {
+    return (bytes + MatrixArena::ALIGNMENT - 1) / MatrixArena::ALIGNMENT * MatrixArena::ALIGNMENT;
+}
+
+// Open the scope
+MatrixArena::MatrixArena(std::size_t size)
+    : blockSize(roundUp(size > 0 ? size : DEFAULT_BLOCK_SIZE)), head(nullptr), oversized(nullptr),
+      used(0), reserved(0), previous(activeArena) {
+    activeArena = this;
+}
+
+// Return a chain of blocks to the heap
+void MatrixArena::freeBlocks(Block* block) {
+    while (block) {
+        Block* next = block->next;
+        ::operator delete(block, std::align_val_t(ALIGNMENT));
+        block = next;
+    }
+}
+
+// Close the scope and free every block
+MatrixArena::~MatrixArena() {
+    activeArena = previous;
+    freeBlocks(head);
+    freeBlocks(oversized);
+}
+
+// Get a fresh block from the heap
+MatrixArena::Block* MatrixArena::newBlock(std::size_t bytes) {
+    void* raw = ::operator new(ALIGNMENT + bytes, std::align_val_t(ALIGNMENT));
+    Block* block = static_cast<Block*>(raw);
+    block->next = nullptr;
+    block->capacity = bytes;
+    reserved += ALIGNMENT + bytes;
+    return block;
+}
+
+// Bump-allocate from the current block
+void* MatrixArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (alignment > ALIGNMENT)
+        throw std::bad_alloc();
+    bytes = roundUp(bytes);
+    if (bytes > blockSize / 2) { // Large requests get their own block so head keeps its space
+        Block* block = newBlock(bytes);
+        block->next = oversized;
+        oversized = block;
+        return block->payload();
+    }
+    if (!head || used + bytes > head->capacity) {
+        Block* block = newBlock(blockSize);
+        block->next = head;
+        head = block;
+        used = 0;
+    }
+    void* ptr = head->payload() + used;
+    used += bytes;
+    return ptr;
+}
+
+// Roll the bump pointer back when the latest allocation is released first
+void MatrixArena::do_deallocate(void* ptr, std::size_t bytes, std::size_t) {
+    bytes = roundUp(bytes);
+    if (head && static_cast<char*>(ptr) + bytes == head->payload() + used)
+        used -= bytes;
+}
+
+// Only the same arena can free its memory
+bool MatrixArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// Innermost scope of the calling thread
+MatrixArena* MatrixArena::current() {
+    return activeArena;
+}
+
+}
@@ -0,0 +1,181 @@
+// Author: realyoavperetz@gmail.com
+
+#include "MixedPrecision.hpp"
+#include "Gemm.hpp"
+#include "Lu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace operators {
+
+// Refinement rounds before solveMixed falls back to a double factorization
+static constexpr int MAX_REFINEMENTS = 30;
+
+// Innermost open scope of each thread
+static thread_local MixedPrecisionScope* activeScope = nullptr;
+
+// Open the scope
+MixedPrecisionScope::MixedPrecisionScope() : count(0), last(0), worst(0), previous(activeScope) {
+    activeScope = this;
+}
+
+// Close the scope
+MixedPrecisionScope::~MixedPrecisionScope() {
+    activeScope = previous;
+}
+
+void MixedPrecisionScope::record(double residual) {
+    ++count;
+    last = residual;
+    worst = std::max(worst, residual);
+}
+
+// Innermost scope of the calling thread
+MixedPrecisionScope* MixedPrecisionScope::current() {
+    return activeScope;
+}
+
+// y = A * x, or |A| * x when absolute is set
+static void multiplyVector(const SquareMat& a, const std::vector<double>& x, std::vector<double>& y,
+                           bool absolute) {
+    const int n = a.getSize();
+    for (int i = 0; i < n; ++i) {
+        double total = 0;
+        for (int j = 0; j < n; ++j)
+            total += (absolute ? std::abs(a(i, j)) : a(i, j)) * x[j];
+        y[i] = total;
+    }
+}
+
+// Four matrix-vector products against one pseudo-random vector with entries of magnitude 1/2 to 3/2
+double productResidual(const SquareMat& a, const SquareMat& b, const SquareMat& c) {
+    const int n = a.getSize();
+    if (b.getSize() != n || c.getSize() != n) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    std::vector<double> x(n), bx(n), abx(n), cx(n);
+    std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (int j = 0; j < n; ++j) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const double magnitude = 0.5 + static_cast<double>(state >> 11) / 9007199254740992.0;
+        x[j] = (state >> 63) ? -magnitude : magnitude;
+    }
+    multiplyVector(b, x, bx, false);
+    multiplyVector(a, bx, abx, false);
+    multiplyVector(c, x, cx, false);
+
+    for (double& value : x)
+        value = std::abs(value);
+    multiplyVector(b, x, bx, true);
+    multiplyVector(a, bx, x, true); // x now holds the scale |A| |B| |x|
+
+    double residual = 0;
+    for (int i = 0; i < n; ++i)
+        if (x[i] > 0)
+            residual = std::max(residual, std::abs(abx[i] - cx[i]) / x[i]);
+    return residual;
+}
+
+// Product through the mixed-precision kernel
+SquareMat multiplyMixed(const SquareMat& a, const SquareMat& b, double* residual) {
+    if (a.getSize() != b.getSize()) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    const int n = a.getSize();
+    SquareMat result = SquareMat::uninitialized(n);
+    kernels::gemmMixed(n, a.rawData(), a.getStride(), b.rawData(), b.getStride(), result.rawData(),
+                       result.getStride());
+    if (residual)
+        *residual = productResidual(a, b, result);
+    return result;
+}
+
+// Largest absolute row sum
+static double normInf(const SquareMat& a) {
+    double norm = 0;
+    for (int i = 0; i < a.getSize(); ++i) {
+        double total = 0;
+        for (int j = 0; j < a.getSize(); ++j)
+            total += std::abs(a(i, j));
+        norm = std::max(norm, total);
+    }
+    return norm;
+}
+
+// R = B - A * X in double
+static void residualOf(const SquareMat& a, const SquareMat& x, const SquareMat& b, SquareMat& r) {
+    const int n = a.getSize();
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            r(i, j) = b(i, j);
+    kernels::gemm(n, -1.0, a.rawData(), a.getStride(), x.rawData(), x.getStride(), 1.0, r.rawData(), r.getStride());
+}
+
+// Solve with a double factorization
+static SquareMat solveDouble(const SquareMat& a, const SquareMat& b) {
+    const int n = a.getSize();
+    SquareMat lu(a);
+    std::vector<int> pivots(n);
+    if (!kernels::luFactor(n, lu.rawData(), lu.getStride(), pivots.data())) {
+        throw std::invalid_argument("Matrix is singular");
+    }
+    SquareMat x(b);
+    kernels::luSolve(n, lu.rawData(), lu.getStride(), pivots.data(), n, x.rawData(), x.getStride());
+    return x;
+}
+
+// Float factorization with double refinement: stop once ||R|| <= ||X|| ||A|| eps sqrt(n),
+// the same test as LAPACK's dsgesv
+SquareMat solveMixed(const SquareMat& a, const SquareMat& b, double* residual) {
+    if (a.getSize() != b.getSize()) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    const int n = a.getSize();
+    const double normA = normInf(a);
+    const double tolerance = normA * std::numeric_limits<double>::epsilon() * std::sqrt(static_cast<double>(n));
+
+    FloatSquareMat lu = FloatSquareMat::uninitialized(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            lu(i, j) = static_cast<float>(a(i, j));
+    std::vector<int> pivots(n);
+    const bool factored = kernels::luFactor(n, lu.rawData(), lu.getStride(), pivots.data());
+
+    SquareMat x(n), r(b); // X starts at zero, so R = B
+    bool converged = false;
+    if (factored) {
+        FloatSquareMat correction = FloatSquareMat::uninitialized(n);
+        for (int round = 0; round <= MAX_REFINEMENTS && !converged; ++round) {
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j)
+                    correction(i, j) = static_cast<float>(r(i, j));
+            kernels::luSolve(n, lu.rawData(), lu.getStride(), pivots.data(), n, correction.rawData(),
+                             correction.getStride());
+            bool finite = true;
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j) {
+                    x(i, j) += correction(i, j);
+                    finite = finite && std::isfinite(x(i, j));
+                }
+            if (!finite)
+                break;
+            residualOf(a, x, b, r);
+            converged = normInf(r) <= normInf(x) * tolerance;
+        }
+    }
+    if (!converged) {
+        x = solveDouble(a, b);
+        residualOf(a, x, b, r);
+    }
+    if (residual) {
+        const double scale = normA * normInf(x) + normInf(b);
+        *residual = scale > 0 ? normInf(r) / scale : 0;
+    }
+    return x;
+}
+
+}
@@ -0,0 +1,221 @@
+// Author: realyoavperetz@gmail.com
+
+#include "SimdKernels.hpp"
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+namespace operators {
+namespace kernels {
+
+namespace scalar {
+
+// C[0:MR, 0:NR] += A panel * B panel; the accumulators stay in registers
+template <typename T, int MR, int NR>
+static void gemmKernel(int kc, const T* a, const T* b, T* c, int ldc) {
+    T ab[MR][NR] = {};
+    for (int p = 0; p < kc; ++p) {
+        for (int i = 0; i < MR; ++i) {
+            const T ai = a[i];
+            for (int j = 0; j < NR; ++j)
+                ab[i][j] += ai * b[j];
+        }
+        a += MR;
+        b += NR;
+    }
+    for (int i = 0; i < MR; ++i)
+        for (int j = 0; j < NR; ++j)
+            c[static_cast<std::ptrdiff_t>(i) * ldc + j] += ab[i][j];
+}
+
+static const IsaKernels<double> doubleKernels = {{4, 8, gemmKernel<double, 4, 8>}, addRow<double>,
+                                                 subRow<double>, mulRow<double>, mulAddRow<double>,
+                                                 scaleRow<double>, sumRow<double>};
+static const IsaKernels<float> floatKernels = {{4, 16, gemmKernel<float, 4, 16>}, addRow<float>,
+                                               subRow<float>, mulRow<float>, mulAddRow<float>,
+                                               scaleRow<float>, sumRow<float>};
+
+}
+
+// Whether the CPU and the build support an instruction set
+bool isaSupported(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return true;
+#ifdef OPERATORS_X86_KERNELS
+    case Isa::Sse2:
+        return __builtin_cpu_supports("sse2");
+    case Isa::Avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Isa::Avx512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+// Name accepted by MATRIX_ISA
+const char* isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Sse2:
+        return "sse2";
+    case Isa::Avx2:
+        return "avx2";
+    case Isa::Avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+// Best supported instruction set, capped by MATRIX_ISA when it names one
+static Isa detectIsa() {
+    Isa cap = Isa::Avx512;
+    if (const char* requested = std::getenv("MATRIX_ISA")) {
+        for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2, Isa::Avx512})
+            if (std::strcmp(requested, isaName(isa)) == 0)
+                cap = isa;
+    }
+    for (int level = static_cast<int>(cap); level > 0; --level)
+        if (isaSupported(static_cast<Isa>(level)))
+            return static_cast<Isa>(level);
+    return Isa::Scalar;
+}
+
+// Instruction set in use, detected on first use
+static std::atomic<Isa>& currentIsa() {
+    static std::atomic<Isa> isa(detectIsa());
+    return isa;
+}
+
+Isa activeIsa() {
+    return currentIsa().load(std::memory_order_relaxed);
+}
+
+bool setIsa(Isa isa) {
+    if (!isaSupported(isa))
+        return false;
+    currentIsa().store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+// Kernel table of the active instruction set
+template <typename T>
+static const IsaKernels<T>& activeKernels();
+
+template <>
+const IsaKernels<double>& activeKernels<double>() {
+    switch (activeIsa()) {
+#ifdef OPERATORS_X86_KERNELS
+    case Isa::Sse2:
+        return sse2::doubleKernels;
+    case Isa::Avx2:
+        return avx2::doubleKernels;
+    case Isa::Avx512:
+        return avx512::doubleKernels;
+#endif
+    default:
+        return scalar::doubleKernels;
+    }
+}
+
+template <>
+const IsaKernels<float>& activeKernels<float>() {
+    switch (activeIsa()) {
+#ifdef OPERATORS_X86_KERNELS
+    case Isa::Sse2:
+        return sse2::floatKernels;
+    case Isa::Avx2:
+        return avx2::floatKernels;
+    case Isa::Avx512:
+        return avx512::floatKernels;
+#endif
+    default:
+        return scalar::floatKernels;
+    }
+}
+
+// Micro-kernels: vectorized for float and double, portable for the other element types
+template <typename T>
+MicroKernel<T> microKernel() {
+    if constexpr (std::is_same<T, double>::value || std::is_same<T, float>::value)
+        return activeKernels<T>().gemm;
+    else if constexpr (std::is_same<T, std::complex<double>>::value)
+        return {2, 4, scalar::gemmKernel<T, 2, 4>};
+    else
+        return {4, 4, scalar::gemmKernel<T, 4, 4>};
+}
+
+template MicroKernel<float> microKernel<float>();
+template MicroKernel<double> microKernel<double>();
+template MicroKernel<std::int64_t> microKernel<std::int64_t>();
+template MicroKernel<std::complex<double>> microKernel<std::complex<double>>();
+
+// Row kernels of the active instruction set
+template <>
+void addRow<double>(int n, const double* a, const double* b, double* out) {
+    activeKernels<double>().add(n, a, b, out);
+}
+
+template <>
+void subRow<double>(int n, const double* a, const double* b, double* out) {
+    activeKernels<double>().sub(n, a, b, out);
+}
+
+template <>
+void mulRow<double>(int n, const double* a, const double* b, double* out) {
+    activeKernels<double>().mul(n, a, b, out);
+}
+
+template <>
+void mulAddRow<double>(int n, const double* a, const double* b, double* out) {
+    activeKernels<double>().mulAdd(n, a, b, out);
+}
+
+template <>
+void scaleRow<double>(int n, const double* a, double factor, double* out) {
+    activeKernels<double>().scale(n, a, factor, out);
+}
+
+template <>
+double sumRow<double>(int n, const double* a) {
+    return activeKernels<double>().sum(n, a);
+}
+
+template <>
+void addRow<float>(int n, const float* a, const float* b, float* out) {
+    activeKernels<float>().add(n, a, b, out);
+}
+
+template <>
+void subRow<float>(int n, const float* a, const float* b, float* out) {
+    activeKernels<float>().sub(n, a, b, out);
+}
+
+template <>
+void mulRow<float>(int n, const float* a, const float* b, float* out) {
+    activeKernels<float>().mul(n, a, b, out);
+}
+
+template <>
+void mulAddRow<float>(int n, const float* a, const float* b, float* out) {
+    activeKernels<float>().mulAdd(n, a, b, out);
+}
+
+template <>
+void scaleRow<float>(int n, const float* a, float factor, float* out) {
+    activeKernels<float>().scale(n, a, factor, out);
+}
+
+template <>
+float sumRow<float>(int n, const float* a) {
+    return activeKernels<float>().sum(n, a);
+}
+
+}
+}
@@ -1,240 +1,514 @@
 // Author: realyoavperetz@gmail.com
 
 #include "SquareMatrix.hpp"
+#include "MatrixArena.hpp"
+#include "BufferPool.hpp"
+#include "ElementTraits.hpp"
+#include "Gemm.hpp"
+#include "Lu.hpp"
+#include "SimdKernels.hpp"
+#include "MixedPrecision.hpp"
 #include <stdexcept> 
+#include <cstring>
+#include <type_traits>
+#include <vector>
 
 namespace operators {
 
-// Allocate memory for a size x size matrix
-void SquareMat::allocate(int newSize) {
+// Round a row length up to whole cache lines, and add one more line when the
+// row length in bytes is a multiple of 1 KiB so that consecutive rows of
+// power-of-two sized matrices do not map onto the same cache sets
+template <typename T>
+int BasicSquareMat<T>::paddedStride(int n) {
+    const int perLine = static_cast<int>(CACHE_LINE / sizeof(T));
+    int padded = (n + perLine - 1) / perLine * perLine;
+    if (padded % (1024 / sizeof(T)) == 0)
+        padded += perLine;
+    return padded;
+}
+
+// Allocate one contiguous, cache-line aligned block for a size x size matrix,
+// or use the inline buffer for small matrices
+template <typename T>
+void BasicSquareMat<T>::allocate(int newSize, bool zeroFill) {
     size = newSize;
-    data = new double*[size];
-    for (int i = 0; i < size; ++i) {
-        data[i] = new double[size](); // initialize row with zeros
-    }
-}
-
-// Deallocate memory
-void SquareMat::deallocate() {
-    for (int i = 0; i < size; ++i) {
-        delete[] data[i];
+    stride = newSize <= SMALL_SIZE ? newSize : paddedStride(newSize);
+    const std::size_t count = static_cast<std::size_t>(size) * stride;
+    if (newSize <= SMALL_SIZE)
+        data = local;
+    else if (resource)
+        data = static_cast<T*>(resource->allocate(count * sizeof(T), CACHE_LINE));
+    else
+        data = static_cast<T*>(BufferPool::acquire(count * sizeof(T)));
+    if (zeroFill) {
+        for (std::size_t k = 0; k < count; ++k)
+            data[k] = T(0); // initialize all elements with zeros (compiled to a memset)
+    }
+}
+
+// Deallocate memory (inline storage and moved-from matrices have nothing to free)
+template <typename T>
+void BasicSquareMat<T>::deallocate() {
+    if (data && !isInline()) {
+        if (resource)
+            resource->deallocate(data, sizeof(T) * size * stride, CACHE_LINE);
+        else
+            BufferPool::release(data, sizeof(T) * size * stride);
     }
-    delete[] data;
     data = nullptr;
     size = 0;
+    stride = 0;
 }
 
 // Constructor with size
-SquareMat::SquareMat(int newSize) {
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int newSize) : resource(defaultResource()) {
+    if (newSize <= 0)
+        throw std::invalid_argument("Matrix size must be positive");
+    allocate(newSize);
+}
+
+// Constructor with size and memory resource
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int newSize, std::pmr::memory_resource* memory)
+    : resource(memory ? memory : defaultResource()) {
     if (newSize <= 0)
         throw std::invalid_argument("Matrix size must be positive");
     allocate(newSize);
 }
 
+// Constructor leaving the elements uninitialized
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int newSize, NoInit, std::pmr::memory_resource* memory)
+    : resource(memory ? memory : defaultResource()) {
+    if (newSize <= 0)
+        throw std::invalid_argument("Matrix size must be positive");
+    allocate(newSize, false);
+}
+
+// Factory for callers that fill every element themselves
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::uninitialized(int size, std::pmr::memory_resource* memory) {
+    return BasicSquareMat(size, NoInit(), memory);
+}
+
+// Innermost arena scope of this thread, or the buffer pool
+template <typename T>
+std::pmr::memory_resource* BasicSquareMat<T>::defaultResource() {
+    return MatrixArena::current();
+}
+
+// Results inherit the resource of the matrix they are computed from
+template <typename T>
+std::pmr::memory_resource* BasicSquareMat<T>::derivedResource() const {
+    return resource ? resource : defaultResource();
+}
+
 // Copy constructor
-SquareMat::SquareMat(const SquareMat& other) {
-    allocate(other.size);
-    for (int i = 0; i < size; ++i)
-        for (int j = 0; j < size; ++j)
-            data[i][j] = other.data[i][j];
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(const BasicSquareMat& other) : resource(defaultResource()) {
+    allocate(other.size, false);
+    copyElements(other);
+}
+
+// Copy constructor into a chosen resource
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(const BasicSquareMat& other, std::pmr::memory_resource* memory)
+    : resource(memory ? memory : defaultResource()) {
+    allocate(other.size, false);
+    copyElements(other);
+}
+
+// Move constructor
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(BasicSquareMat&& other) noexcept
+    : data(other.data), size(other.size), stride(other.stride), resource(other.resource) {
+    if (other.isInline()) {
+        std::memcpy(local, other.local, sizeof(local)); // Fixed size: a few vector moves
+        data = local;
+    }
+    other.data = nullptr;
+    other.size = 0;
+    other.stride = 0;
 }
 
 // Destructor
-SquareMat::~SquareMat() {
+template <typename T>
+BasicSquareMat<T>::~BasicSquareMat() {
     deallocate();
 }
 
 // Assignment operator
-SquareMat& SquareMat::operator=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator=(const BasicSquareMat& other) {
     if (this != &other) {
-        deallocate();
-        allocate(other.size);
-        for (int i = 0; i < size; ++i)
-            for (int j = 0; j < size; ++j)
-                data[i][j] = other.data[i][j];
+        if (size != other.size) { // Reuse the existing buffer when the sizes match
+            deallocate(); // The new buffer comes from the same resource (or the pool) as the old one
+            allocate(other.size, false);
+        }
+        copyElements(other);
     }
     return *this;
 }
 
+// Copy the elements of a same-sized matrix, padding included
+template <typename T>
+void BasicSquareMat<T>::copyElements(const BasicSquareMat& other) {
+    if (isInline())
+        std::memcpy(local, other.local, sizeof(local)); // Fixed size: a few vector moves
+    else
+        std::memcpy(data, other.data, sizeof(T) * size * stride);
+}
+
+// Move assignment operator
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator=(BasicSquareMat&& other) {
+    const bool sameResource = resource == other.resource ||
+                              (resource && other.resource && resource->is_equal(*other.resource));
+    if (!sameResource)
+        return *this = other; // Keep our own storage rather than adopting a buffer from another resource
+    swap(other); // other releases our old buffer when it is destroyed
+    return *this;
+}
+
+// Swap contents with another matrix
+template <typename T>
+void BasicSquareMat<T>::swap(BasicSquareMat& other) noexcept {
+    if (this == &other)
+        return;
+    // Inline elements cannot change owners, so exchange the buffers themselves
+    T* mine = isInline() ? other.local : data;
+    T* theirs = other.isInline() ? local : other.data;
+    if (isInline() || other.isInline()) {
+        T tmpLocal[SMALL_SIZE * SMALL_SIZE];
+        std::memcpy(tmpLocal, local, sizeof(local));
+        std::memcpy(local, other.local, sizeof(local));
+        std::memcpy(other.local, tmpLocal, sizeof(local));
+    }
+    data = theirs;
+    other.data = mine;
+    int tmpSize = size;
+    size = other.size;
+    other.size = tmpSize;
+    int tmpStride = stride;
+    stride = other.stride;
+    other.stride = tmpStride;
+    std::pmr::memory_resource* tmpResource = resource;
+    resource = other.resource;
+    other.resource = tmpResource;
+}
+
 // --- Operators in specified order ---
 
 // 1. Addition operator
-SquareMat SquareMat::operator+(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator+(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = data[i][j] + other[i][j];
-        }
-    }
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    for (int i = 0; i < size; ++i)
+        kernels::addRow(size, row(i), other.row(i), result.row(i));
     return result;
 }
 
 // 2. Subtraction operator
-SquareMat SquareMat::operator-(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator-(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = data[i][j] - other[i][j];
-        }
-    }
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    for (int i = 0; i < size; ++i)
+        kernels::subRow(size, row(i), other.row(i), result.row(i));
     return result;
 }
 
 // 3. Unary minus operator
-SquareMat SquareMat::operator-() const {
-    SquareMat result(size);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator-() const {
+    BasicSquareMat result(size, NoInit(), derivedResource());
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = -data[i][j];
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            result.data[j] = -data[j];
         }
     }
     return result;
 }
 
-// 4. Matrix multiplication operator
-SquareMat SquareMat::operator*(const SquareMat& other) const {
+// 4. Matrix multiplication operator (cache-blocked kernel, see Gemm.cpp)
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator*(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = 0;
-            for (int k = 0; k < size; ++k) {
-                result[i][j] += data[i][k] * other[k][j];
-            }
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    result.assignProduct(*this, other);
+    return result;
+}
+
+// Product into an existing buffer
+template <typename T>
+void BasicSquareMat<T>::assignProduct(const BasicSquareMat& a, const BasicSquareMat& b) {
+    if constexpr (std::is_same<T, double>::value) {
+        if (MixedPrecisionScope* mixed = MixedPrecisionScope::current()) { // Opted in to float32 compute
+            kernels::gemmMixed(size, a.data, a.stride, b.data, b.stride, data, stride);
+            mixed->record(productResidual(a, b, *this));
+            return;
         }
     }
+    kernels::gemm(size, T(1), a.data, a.stride, b.data, b.stride, T(0), data, stride);
+}
+
+// Product with the transpose of the right operand, read in place
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::multiplyTransposed(const BasicSquareMat& other) const {
+    if (size != other.size) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    if (&other == this) {
+        return gram();
+    }
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    kernels::gemm(kernels::Transpose::No, kernels::Transpose::Yes, size, T(1), data, stride, other.data,
+                  other.stride, T(0), result.data, result.stride);
     return result;
 }
 
-// 5a. Scalar multiplication operator (from right)
-SquareMat SquareMat::operator*(double scalar) const {
-    SquareMat result(size);
+// A * ~A: the lower triangle from the symmetric kernel, mirrored into the upper one
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::gram() const {
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    kernels::syrk(kernels::Triangle::Lower, size, T(1), data, stride, T(0), result.data, result.stride);
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = data[i][j] * scalar;
+        T* r = result.row(i);
+        for (int j = i + 1; j < size; ++j) {
+            r[j] = result.row(j)[i];
         }
     }
     return result;
 }
 
-// 5b. Scalar multiplication operator (from left)
-SquareMat operator*(double scalar, const SquareMat& mat) {
-    return mat * scalar; // Reuse the existing method
+// Product with the transpose of the left operand, read in place
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::transposedMultiply(const BasicSquareMat& other) const {
+    if (size != other.size) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    kernels::gemm(kernels::Transpose::Yes, kernels::Transpose::No, size, T(1), data, stride, other.data,
+                  other.stride, T(0), result.data, result.stride);
+    return result;
+}
+
+// 5a. Scalar multiplication operator (from right)
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator*(T scalar) const {
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    for (int i = 0; i < size; ++i)
+        kernels::scaleRow(size, row(i), scalar, result.row(i));
+    return result;
 }
 
 // 6. Element-wise multiplication operator
-SquareMat SquareMat::operator%(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator%(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = data[i][j] * other[i][j];
-        }
-    }
+    BasicSquareMat result(size, NoInit(), derivedResource());
+    for (int i = 0; i < size; ++i)
+        kernels::mulRow(size, row(i), other.row(i), result.row(i));
     return result;
 }
 
 // 7. Scalar modulo operator
-SquareMat SquareMat::operator%(int scalar) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator%(int scalar) const {
     if (scalar == 0) {
         throw std::invalid_argument("Modulo by zero");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size, NoInit(), derivedResource());
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = static_cast<int>(data[i][j]) % scalar;
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            result.data[j] = ElementTraits<T>::modulo(data[j], scalar);
         }
     }
     return result;
 }
 
 // 8. Scalar division operator
-SquareMat SquareMat::operator/(double scalar) const {
-    if (scalar == 0) {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator/(T scalar) const {
+    if (scalar == T(0)) {
         throw std::invalid_argument("Division by zero");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size, NoInit(), derivedResource());
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result[i][j] = data[i][j] / scalar;
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            result.data[j] = data[j] / scalar;
         }
     }
     return result;
 }
 
 // 9. Power operator
-SquareMat SquareMat::operator^(int power) const {
-    if (power < 0) {
-        throw std::invalid_argument("Negative powers are not supported");
-    }
-    SquareMat result(size);
-    SquareMat base(*this);
-    // Initialize result as identity matrix
-    for (int i = 0; i < size; ++i) {
-        result[i][i] = 1;
+
+// Repeated squaring shared by operator^ and powMod, for power >= 1: multiply(out, x, y) writes
+// x * y into out, which aliases neither. Every product is written into scratch and swapped into
+// place (a pointer exchange), so the three buffers are the only matrices the loop touches
+template <typename Mat, typename Multiply>
+static Mat raiseToPower(const Mat& a, std::int64_t power, std::pmr::memory_resource* resource,
+                        Multiply multiply) {
+    if (power == 1) {
+        return Mat(a, resource);
+    }
+    const int n = a.getSize();
+    Mat base = Mat::uninitialized(n, resource);
+    Mat scratch = Mat::uninitialized(n, resource);
+    const Mat* square = &a; // Current repeated square, read in place until first squared
+    while (power % 2 == 0) {
+        multiply(scratch, *square, *square);
+        base.swap(scratch);
+        square = &base;
+        power /= 2;
     }
-    while (power) {
+    Mat result(*square, resource); // The lowest set bit replaces the identity
+    while (power /= 2) {
+        multiply(scratch, *square, *square);
+        base.swap(scratch);
+        square = &base;
         if (power % 2 == 1) {
-            result = result * base;
+            multiply(scratch, result, base);
+            result.swap(scratch);
         }
-        base = base * base;
-        power /= 2;
     }
     return result;
 }
 
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator^(int power) const {
+    const auto multiply = [](BasicSquareMat& out, const BasicSquareMat& x, const BasicSquareMat& y) {
+        out.assignProduct(x, y);
+    };
+    if (power < 0) { // A^-k = (A^-1)^k: one factorization, then the usual squaring
+        BasicSquareMat inv = inverse();
+        if (power == -1) {
+            return inv;
+        }
+        return raiseToPower(inv, -static_cast<std::int64_t>(power), derivedResource(), multiply);
+    }
+    if (power == 0) {
+        BasicSquareMat identity(size, derivedResource());
+        for (int i = 0; i < size; ++i) {
+            identity.row(i)[i] = T(1);
+        }
+        return identity;
+    }
+    return raiseToPower(*this, power, derivedResource(), multiply);
+}
+
+// Inverse: factor a copy once, then solve for the columns of the identity in place
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::inverse() const {
+    if constexpr (std::is_same<T, std::int64_t>::value) {
+        throw std::invalid_argument("Integer matrices cannot be inverted");
+    } else {
+        BasicSquareMat lu(*this, derivedResource());
+        BasicSquareMat result(size, derivedResource());
+        for (int i = 0; i < size; ++i) {
+            result.row(i)[i] = T(1);
+        }
+        std::vector<int> pivots(size);
+        if (!kernels::luFactor(size, lu.data, lu.stride, pivots.data())) {
+            throw std::invalid_argument("Matrix is singular");
+        }
+        kernels::luSolve(size, lu.data, lu.stride, pivots.data(), size, result.data, result.stride);
+        return result;
+    }
+}
+
+// Modular power: operands reduced into [0, modulus) once, then every product reduced by gemmMod
+IntSquareMat powMod(const IntSquareMat& a, std::int64_t power, std::int64_t modulus) {
+    if (power < 0) {
+        throw std::invalid_argument("Negative powers are not supported");
+    }
+    if (modulus <= 0) {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+    const int n = a.getSize();
+    if (power == 0) {
+        IntSquareMat identity(n, a.getResource());
+        for (int i = 0; i < n; ++i)
+            identity(i, i) = 1 % modulus;
+        return identity;
+    }
+    IntSquareMat reduced = IntSquareMat::uninitialized(n, a.getResource());
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            const std::int64_t r = a(i, j) % modulus;
+            reduced(i, j) = r < 0 ? r + modulus : r;
+        }
+    return raiseToPower(reduced, power, a.getResource(),
+                        [modulus](IntSquareMat& out, const IntSquareMat& x, const IntSquareMat& y) {
+                            kernels::gemmMod(x.getSize(), x.rawData(), x.getStride(), y.rawData(), y.getStride(),
+                                             out.rawData(), out.getStride(), modulus);
+                        });
+}
+
 // 10. Increment operators
 // Pre-increment operator
-SquareMat& SquareMat::operator++() {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator++() {
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] += 1;
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            data[j] += T(1);
         }
     }
     return *this;
 }
 
 // Post-increment operator
-SquareMat SquareMat::operator++(int) {
-    SquareMat temp(*this); // Save current state
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator++(int) {
+    BasicSquareMat temp(*this, derivedResource()); // Save current state
     ++(*this);             // Call pre-increment
     return temp;           // Return saved state
 }
 
 // 11. Decrement operators
 // Pre-decrement operator
-SquareMat& SquareMat::operator--() {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator--() {
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] -= 1;
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            data[j] -= T(1);
         }
     }
     return *this;
 }
 
 // Post-decrement operator
-SquareMat SquareMat::operator--(int) {
-    SquareMat temp(*this); // Save current state
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator--(int) {
+    BasicSquareMat temp(*this, derivedResource()); // Save current state
     --(*this);             // Call pre-decrement
     return temp;           // Return saved state
 }
 
 // 12. Transpose operator
-SquareMat SquareMat::operator~() const {
-    SquareMat result(size);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator~() const {
+    BasicSquareMat result(size, NoInit(), derivedResource());
     for (int i = 0; i < size; ++i) {
+        T* r = result.row(i);
         for (int j = 0; j < size; ++j) {
-            result[i][j] = data[j][i];
+            r[j] = row(j)[i];
         }
     }
     return result;
@@ -242,176 +516,223 @@ SquareMat SquareMat::operator~() const {
 
 // 13. Access operators
 // Row accessor (non-const)
-double* SquareMat::operator[](int index) {
+template <typename T>
+T* BasicSquareMat<T>::operator[](int index) {
     if (index < 0 || index >= size)
         throw std::out_of_range("Index out of bounds");
-    return data[index];
+    return row(index);
 }
 
 // Row accessor (const version)
-const double* SquareMat::operator[](int index) const {
+template <typename T>
+const T* BasicSquareMat<T>::operator[](int index) const {
     if (index < 0 || index >= size)
         throw std::out_of_range("Index out of bounds");
-    return data[index];
+    return row(index);
+}
+
+// Element accessor with bounds checking (non-const)
+template <typename T>
+T& BasicSquareMat<T>::at(int i, int j) {
+    if (i < 0 || i >= size || j < 0 || j >= size)
+        throw std::out_of_range("Index out of bounds");
+    return row(i)[j];
+}
+
+// Element accessor with bounds checking (const version)
+template <typename T>
+const T& BasicSquareMat<T>::at(int i, int j) const {
+    if (i < 0 || i >= size || j < 0 || j >= size)
+        throw std::out_of_range("Index out of bounds");
+    return row(i)[j];
 }
 
 // Helper function to calculate the sum of all elements in the matrix
-inline double sumElements(const SquareMat& mat) {
-    double sum = 0;
-    for (int i = 0; i < mat.size; ++i) {
-        for (int j = 0; j < mat.size; ++j) {
-            sum += mat[i][j];
-        }
-    }
-    return sum;
+template <typename T>
+T BasicSquareMat<T>::sum() const {
+    T total = T(0);
+    for (int i = 0; i < size; ++i)
+        total += kernels::sumRow(size, row(i));
+    return total;
 }
 
 // 14. Equality operator
-bool SquareMat::operator==(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator==(const BasicSquareMat& other) const {
     return sumElements(*this) == sumElements(other);
 }
 
 // 15. Inequality operator
-bool SquareMat::operator!=(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator!=(const BasicSquareMat& other) const {
     return !(*this == other);
 }
 
 // Extra comparison operators
 // Less than operator
-bool SquareMat::operator<(const SquareMat& other) const {
-    return sumElements(*this) < sumElements(other);
+template <typename T>
+bool BasicSquareMat<T>::operator<(const BasicSquareMat& other) const {
+    return ElementTraits<T>::less(sumElements(*this), sumElements(other));
 }
 
 // Greater than operator
-bool SquareMat::operator>(const SquareMat& other) const {
-    return sumElements(*this) > sumElements(other);
+template <typename T>
+bool BasicSquareMat<T>::operator>(const BasicSquareMat& other) const {
+    return ElementTraits<T>::less(sumElements(other), sumElements(*this));
 }
 
 // Less than or equal to operator
-bool SquareMat::operator<=(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator<=(const BasicSquareMat& other) const {
     return !(*this > other);
 }
 
 // Greater than or equal to operator
-bool SquareMat::operator>=(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator>=(const BasicSquareMat& other) const {
     return !(*this < other);
 }
 
-// Helper function to calculate the determinant of a matrix
-static double determinant(double** matrix, int n) {
-    if (n == 1) return matrix[0][0];
-    if (n == 2) return matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
-    double det = 0;
-    double** submatrix = new double*[n-1];
-    for (int i = 0; i < n-1; ++i) {
-        submatrix[i] = new double[n-1];
-    }
+// Helper function to calculate the determinant of a row-major n x n matrix
+// whose rows are ld elements apart
+template <typename T>
+static T determinant(const T* matrix, int n, int ld) {
+    if (n == 1) return matrix[0];
+    if (n == 2) return matrix[0] * matrix[ld + 1] - matrix[1] * matrix[ld];
+    T det = T(0);
+    const int m = n - 1;
+    T* submatrix = new T[m * m];
     for (int x = 0; x < n; ++x) {
-        int subi = 0;
+        int subk = 0;
         for (int i = 1; i < n; ++i) {
-            int subj = 0;
             for (int j = 0; j < n; ++j) {
                 if (j == x) continue;
-                submatrix[subi][subj] = matrix[i][j];
-                ++subj;
+                submatrix[subk++] = matrix[i * ld + j];
             }
-            ++subi;
         }
-        det += (x % 2 == 0 ? 1 : -1) * matrix[0][x] * determinant(submatrix, n-1);
-    }
-    for (int i = 0; i < n-1; ++i) {
-        delete[] submatrix[i];
+        const T sign = x % 2 == 0 ? T(1) : T(-1);
+        det += sign * matrix[x] * determinant(submatrix, m, m);
     }
     delete[] submatrix;
     return det;
 }
 
 // 16. Determinant operator
-double SquareMat::operator!() const {
-    return determinant(data, size);
+template <typename T>
+T BasicSquareMat<T>::operator!() const {
+    return determinant(data, size, stride);
 }
 
 // 17. Compound assignment operators
 // Compound assignment: Addition
-SquareMat& SquareMat::operator+=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator+=(const BasicSquareMat& other) {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] += other[i][j];
-        }
-    }
+    for (int i = 0; i < size; ++i)
+        kernels::addRow(size, row(i), other.row(i), row(i));
     return *this;
 }
 
 // Compound assignment: Subtraction
-SquareMat& SquareMat::operator-=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator-=(const BasicSquareMat& other) {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] -= other[i][j];
-        }
-    }
+    for (int i = 0; i < size; ++i)
+        kernels::subRow(size, row(i), other.row(i), row(i));
     return *this;
 }
 
-// Compound assignment: Matrix multiplication
-SquareMat& SquareMat::operator*=(const SquareMat& other) {
-    *this = *this * other; // Reuse the existing multiplication operator
+// Compound assignment: Matrix multiplication (product into a scratch buffer that then becomes ours)
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator*=(const BasicSquareMat& other) {
+    accumulateProduct(T(1), *this, other, T(0));
     return *this;
 }
 
 // Compound assignment: Division by scalar
-SquareMat& SquareMat::operator/=(double scalar) {
-    if (scalar == 0) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator/=(T scalar) {
+    if (scalar == T(0)) {
         throw std::invalid_argument("Division by zero");
     }
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] /= scalar;
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            data[j] /= scalar;
         }
     }
     return *this;
 }
 
 // Compound assignment: Modulo by scalar
-SquareMat& SquareMat::operator%=(int scalar) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator%=(int scalar) {
     if (scalar == 0) {
         throw std::invalid_argument("Modulo by zero");
     }
     for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] = static_cast<int>(data[i][j]) % scalar;
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(i) * stride;
+        for (std::ptrdiff_t j = start; j < start + size; ++j) {
+            data[j] = ElementTraits<T>::modulo(data[j], scalar);
         }
     }
     return *this;
 }
 
 // Compound assignment: Element-wise multiplication
-SquareMat& SquareMat::operator%=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator%=(const BasicSquareMat& other) {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must be of the same size");
     }
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] *= other[i][j];
-        }
-    }
+    for (int i = 0; i < size; ++i)
+        kernels::mulRow(size, row(i), other.row(i), row(i));
     return *this;
 }
 
+// this = alpha * a * b + beta * this; the kernel cannot write over its own operands,
+// so when this is one of them the result is built in a scratch buffer and swapped in
+template <typename T>
+void BasicSquareMat<T>::accumulateProduct(T alpha, const BasicSquareMat& a, const BasicSquareMat& b, T beta) {
+    if (a.size != size || b.size != size) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    if (this != &a && this != &b) {
+        kernels::gemm(size, alpha, a.data, a.stride, b.data, b.stride, beta, data, stride);
+        return;
+    }
+    BasicSquareMat scratch(size, NoInit(), resource);
+    if (beta != T(0)) {
+        scratch.copyElements(*this);
+    }
+    kernels::gemm(size, alpha, a.data, a.stride, b.data, b.stride, beta, scratch.data, scratch.stride);
+    if (scratch.resource == resource) {
+        swap(scratch);
+    } else {
+        copyElements(scratch); // Scratch came from an arena scope this matrix may outlive
+    }
+}
+
 // 18. Output operator
-std::ostream& operator<<(std::ostream& os, const SquareMat& mat) {
-    for (int i = 0; i < mat.size; ++i) {
-        for (int j = 0; j < mat.size; ++j) {
-            os << mat.data[i][j] << " ";
+template <typename T>
+void BasicSquareMat<T>::print(std::ostream& os) const {
+    for (int i = 0; i < size; ++i) {
+        const T* r = row(i);
+        for (int j = 0; j < size; ++j) {
+            os << r[j] << " ";
         }
         os << std::endl;
     }
-    return os;
 }
 
+// Element types compiled into the library
+template class BasicSquareMat<float>;
+template class BasicSquareMat<double>;
+template class BasicSquareMat<std::int64_t>;
+template class BasicSquareMat<std::complex<double>>;
+
 } 
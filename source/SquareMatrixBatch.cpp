@@ -0,0 +1,311 @@
+// Author: realyoavperetz@gmail.com
+
+#include "SquareMatrixBatch.hpp"
+#include "BufferPool.hpp"
+#include "SimdKernels.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+namespace operators {
+
+// Matrices handled per step of the product and the determinant, so the planes of
+// the slice being worked on stay in cache instead of streaming every plane per element
+static constexpr int BATCH_CHUNK = 256;
+
+// Allocate all planes as one block; every plane starts on a cache line
+template <typename T>
+void BasicSquareMatBatch<T>::allocate(int newSize, int newCount, bool zeroFill) {
+    if (newSize <= 0) {
+        throw std::invalid_argument("Matrix size must be positive");
+    }
+    if (newCount < 0) {
+        throw std::invalid_argument("Batch count must not be negative");
+    }
+    const int perLine = static_cast<int>(CACHE_LINE / sizeof(T));
+    size = newSize;
+    count = newCount;
+    planeStride = std::max(perLine, (newCount + perLine - 1) / perLine * perLine);
+    const std::size_t total = static_cast<std::size_t>(size) * size * planeStride;
+    data = static_cast<T*>(BufferPool::acquire(total * sizeof(T)));
+    if (zeroFill)
+        std::fill(data, data + total, T(0));
+}
+
+// Deallocate the planes
+template <typename T>
+void BasicSquareMatBatch<T>::deallocate() {
+    if (data)
+        BufferPool::release(data, sizeof(T) * size * size * planeStride);
+    data = nullptr;
+}
+
+// Constructor
+template <typename T>
+BasicSquareMatBatch<T>::BasicSquareMatBatch(int size, int count) {
+    allocate(size, count);
+}
+
+// Constructor without zero-filling, for results
+template <typename T>
+BasicSquareMatBatch<T>::BasicSquareMatBatch(int size, int count, NoInit) {
+    allocate(size, count, false);
+}
+
+// Gather matrices into planes
+template <typename T>
+BasicSquareMatBatch<T>::BasicSquareMatBatch(const std::vector<BasicSquareMat<T>>& matrices) {
+    if (matrices.empty()) {
+        throw std::invalid_argument("Batch needs at least one matrix");
+    }
+    for (const BasicSquareMat<T>& mat : matrices) { // Check before allocating, nothing to free on throw
+        if (mat.getSize() != matrices.front().getSize()) {
+            throw std::invalid_argument("Matrices must be of the same size");
+        }
+    }
+    allocate(matrices.front().getSize(), static_cast<int>(matrices.size()), false);
+    for (int index = 0; index < count; ++index)
+        set(index, matrices[index]);
+}
+
+// Identity batch
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::identity(int size, int count) {
+    BasicSquareMatBatch result(size, count);
+    for (int i = 0; i < size; ++i)
+        std::fill(result.plane(i, i), result.plane(i, i) + count, T(1));
+    return result;
+}
+
+// Copy constructor
+template <typename T>
+BasicSquareMatBatch<T>::BasicSquareMatBatch(const BasicSquareMatBatch& other) {
+    allocate(other.size, other.count, false);
+    std::memcpy(data, other.data, sizeof(T) * size * size * planeStride);
+}
+
+// Move constructor
+template <typename T>
+BasicSquareMatBatch<T>::BasicSquareMatBatch(BasicSquareMatBatch&& other) noexcept
+    : data(other.data), size(other.size), count(other.count), planeStride(other.planeStride) {
+    other.data = nullptr;
+    other.size = 0;
+    other.count = 0;
+    other.planeStride = 0;
+}
+
+// Destructor
+template <typename T>
+BasicSquareMatBatch<T>::~BasicSquareMatBatch() {
+    deallocate();
+}
+
+// Assignment operator
+template <typename T>
+BasicSquareMatBatch<T>& BasicSquareMatBatch<T>::operator=(const BasicSquareMatBatch& other) {
+    if (this != &other) {
+        if (size != other.size || planeStride != other.planeStride) { // Reuse the planes when the shape matches
+            deallocate();
+            allocate(other.size, other.count, false);
+        }
+        count = other.count;
+        std::memcpy(data, other.data, sizeof(T) * size * size * planeStride);
+    }
+    return *this;
+}
+
+// Move assignment operator
+template <typename T>
+BasicSquareMatBatch<T>& BasicSquareMatBatch<T>::operator=(BasicSquareMatBatch&& other) noexcept {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+    std::swap(count, other.count);
+    std::swap(planeStride, other.planeStride);
+    return *this;
+}
+
+template <typename T>
+void BasicSquareMatBatch<T>::checkShape(const BasicSquareMatBatch& other) const {
+    if (size != other.size) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    if (count != other.count) {
+        throw std::invalid_argument("Batches must hold the same number of matrices");
+    }
+}
+
+template <typename T>
+void BasicSquareMatBatch<T>::checkIndex(int index) const {
+    if (index < 0 || index >= count) {
+        throw std::out_of_range("Batch index out of range");
+    }
+}
+
+// Copy one matrix out of the planes
+template <typename T>
+BasicSquareMat<T> BasicSquareMatBatch<T>::get(int index) const {
+    checkIndex(index);
+    BasicSquareMat<T> result = BasicSquareMat<T>::uninitialized(size);
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            result(i, j) = plane(i, j)[index];
+    return result;
+}
+
+// Write one matrix into the planes
+template <typename T>
+void BasicSquareMatBatch<T>::set(int index, const BasicSquareMat<T>& mat) {
+    checkIndex(index);
+    if (mat.getSize() != size) {
+        throw std::invalid_argument("Matrices must be of the same size");
+    }
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            plane(i, j)[index] = mat(i, j);
+}
+
+// Scatter the planes back into matrices
+template <typename T>
+std::vector<BasicSquareMat<T>> BasicSquareMatBatch<T>::toMatrices() const {
+    std::vector<BasicSquareMat<T>> result;
+    result.reserve(count);
+    for (int index = 0; index < count; ++index)
+        result.push_back(get(index));
+    return result;
+}
+
+// Addition: one row kernel call per plane
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::operator+(const BasicSquareMatBatch& other) const {
+    checkShape(other);
+    BasicSquareMatBatch result(size, count, NoInit());
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            kernels::addRow(count, plane(i, j), other.plane(i, j), result.plane(i, j));
+    return result;
+}
+
+// Subtraction
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::operator-(const BasicSquareMatBatch& other) const {
+    checkShape(other);
+    BasicSquareMatBatch result(size, count, NoInit());
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            kernels::subRow(count, plane(i, j), other.plane(i, j), result.plane(i, j));
+    return result;
+}
+
+// Product: plane (i, j) of the result is the sum over k of planes (i, k) and (k, j)
+// multiplied lane by lane, one cache-sized slice of the batch at a time
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::operator*(const BasicSquareMatBatch& other) const {
+    checkShape(other);
+    BasicSquareMatBatch result(size, count, NoInit());
+    for (int first = 0; first < count; first += BATCH_CHUNK) {
+        const int width = std::min(BATCH_CHUNK, count - first);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                T* out = result.plane(i, j) + first;
+                kernels::mulRow(width, plane(i, 0) + first, other.plane(0, j) + first, out);
+                for (int k = 1; k < size; ++k)
+                    kernels::mulAddRow(width, plane(i, k) + first, other.plane(k, j) + first, out);
+            }
+        }
+    }
+    return result;
+}
+
+// Scalar multiplication
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::operator*(T scalar) const {
+    BasicSquareMatBatch result(size, count, NoInit());
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            kernels::scaleRow(count, plane(i, j), scalar, result.plane(i, j));
+    return result;
+}
+
+// Power by repeated squaring, starting from the lowest set bit instead of the identity
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::operator^(int power) const {
+    if (power < 0) {
+        throw std::invalid_argument("Negative powers are not supported");
+    }
+    if (power == 0)
+        return identity(size, count);
+    BasicSquareMatBatch base(*this);
+    while (power % 2 == 0) {
+        base = base * base;
+        power /= 2;
+    }
+    BasicSquareMatBatch result(base);
+    while (power /= 2) {
+        base = base * base;
+        if (power % 2 == 1)
+            result = result * base;
+    }
+    return result;
+}
+
+// Transpose: whole planes change places
+template <typename T>
+BasicSquareMatBatch<T> BasicSquareMatBatch<T>::operator~() const {
+    BasicSquareMatBatch result(size, count, NoInit());
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            std::memcpy(result.plane(i, j), plane(j, i), sizeof(T) * count);
+    return result;
+}
+
+// Determinants by Laplace expansion shared across the batch: the minor of the bottom k rows
+// on a column set S (a bit mask) expands along its top row into minors of the bottom k - 1
+// rows on S minus one column. Every mask is built from smaller masks, so walking the masks
+// in increasing order has each minor ready before it is needed; the full mask is the determinant.
+// The work grows like 2^size * size instead of size!, with positive and negative terms
+// gathered separately so that every step is a vectorized multiply-add.
+template <typename T>
+std::vector<T> BasicSquareMatBatch<T>::operator!() const {
+    std::vector<T> result(count);
+    if (size > BATCH_DETERMINANT_LIMIT) {
+        for (int index = 0; index < count; ++index)
+            result[index] = !get(index);
+        return result;
+    }
+    const int masks = 1 << size;
+    std::vector<T> minors(static_cast<std::size_t>(masks) * BATCH_CHUNK);
+    std::vector<T> negative(BATCH_CHUNK);
+    for (int first = 0; first < count; first += BATCH_CHUNK) {
+        const int width = std::min(BATCH_CHUNK, count - first);
+        for (int mask = 1; mask < masks; ++mask) {
+            T* minor = minors.data() + static_cast<std::ptrdiff_t>(mask) * BATCH_CHUNK;
+            const int r = size - __builtin_popcount(mask); // Top row of this minor
+            if (r == size - 1) { // Single column: the bottom-row element itself
+                std::memcpy(minor, plane(r, __builtin_ctz(mask)) + first, sizeof(T) * width);
+                continue;
+            }
+            std::fill(minor, minor + width, T(0));
+            std::fill(negative.begin(), negative.begin() + width, T(0));
+            bool positive = true;
+            for (int j = 0; j < size; ++j) {
+                if (!(mask & (1 << j)))
+                    continue;
+                const T* rest = minors.data() + static_cast<std::ptrdiff_t>(mask ^ (1 << j)) * BATCH_CHUNK;
+                kernels::mulAddRow(width, plane(r, j) + first, rest, positive ? minor : negative.data());
+                positive = !positive;
+            }
+            kernels::subRow(width, minor, negative.data(), minor);
+        }
+        std::memcpy(result.data() + first, minors.data() + static_cast<std::ptrdiff_t>(masks - 1) * BATCH_CHUNK,
+                    sizeof(T) * width);
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported element types
+template class BasicSquareMatBatch<float>;
+template class BasicSquareMatBatch<double>;
+template class BasicSquareMatBatch<std::int64_t>;
+template class BasicSquareMatBatch<std::complex<double>>;
+
+}
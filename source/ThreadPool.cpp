@@ -0,0 +1,177 @@
+// Author: realyoavperetz@gmail.com
+
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace operators {
+
+// Thread count used when none is set: MATRIX_THREADS, else the hardware threads
+static int defaultThreadCount() {
+    if (const char* value = std::getenv("MATRIX_THREADS")) {
+        const int count = std::atoi(value);
+        if (count > 0)
+            return count;
+    }
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+// Set on pool workers and on callers while they run a job, so nested jobs run inline
+static thread_local bool insideJob = false;
+
+// Workers plus the job they are currently sharing
+struct WorkerPool {
+    std::mutex submit; // Held for a whole job, so jobs from different threads take turns
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::thread* workers = nullptr;
+    int workerCount = 0;
+    std::atomic<int> requested{0}; // 0 means not resolved yet
+
+    // Current job
+    const std::function<void(int)>* task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{0};
+    int running = 0;                  // Workers that have not finished the job
+    unsigned long long generation = 0; // Bumped for every job and for shutdown
+    bool stopping = false;
+    std::exception_ptr error;
+
+    ~WorkerPool() { stopWorkers(); }
+
+    // Claim and run tasks until none are left
+    void drain() {
+        for (int index = nextTask.fetch_add(1); index < taskCount; index = nextTask.fetch_add(1)) {
+            try {
+                (*task)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    }
+
+    void workerLoop(unsigned long long seen) {
+        insideJob = true;
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            wake.wait(guard, [&] { return generation != seen; });
+            seen = generation;
+            if (stopping)
+                return;
+            guard.unlock();
+            drain();
+            guard.lock();
+            if (--running == 0)
+                done.notify_one();
+        }
+    }
+
+    // Workers only pick up jobs published after they start
+    void startWorkers(int count) {
+        unsigned long long current;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current = generation;
+        }
+        workers = new std::thread[count];
+        workerCount = count;
+        for (int i = 0; i < count; ++i)
+            workers[i] = std::thread([this, current] { workerLoop(current); });
+    }
+
+    void stopWorkers() {
+        if (!workers)
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+            ++generation;
+        }
+        wake.notify_all();
+        for (int i = 0; i < workerCount; ++i)
+            workers[i].join();
+        delete[] workers;
+        workers = nullptr;
+        workerCount = 0;
+        stopping = false;
+    }
+};
+
+static WorkerPool& workerPool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+// Join the current workers; the next job starts the new count
+void ThreadPool::setThreadCount(int count) {
+    WorkerPool& pool = workerPool();
+    std::lock_guard<std::mutex> job(pool.submit);
+    pool.stopWorkers();
+    pool.requested.store(count > 0 ? count : defaultThreadCount(), std::memory_order_relaxed);
+}
+
+// Threads per job, resolving the default on first use
+int ThreadPool::threadCount() {
+    WorkerPool& pool = workerPool();
+    int count = pool.requested.load(std::memory_order_relaxed);
+    if (count == 0) {
+        int unresolved = 0;
+        pool.requested.compare_exchange_strong(unresolved, defaultThreadCount());
+        count = pool.requested.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+// Share the tasks between the workers and the caller
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& task) {
+    const int threads = threadCount();
+    if (count <= 0)
+        return;
+    if (count == 1 || threads <= 1 || insideJob) {
+        for (int index = 0; index < count; ++index)
+            task(index);
+        return;
+    }
+
+    WorkerPool& pool = workerPool();
+    std::lock_guard<std::mutex> job(pool.submit);
+    if (pool.workerCount != threads - 1) {
+        pool.stopWorkers();
+        pool.startWorkers(threads - 1);
+    }
+    {
+        std::lock_guard<std::mutex> guard(pool.lock);
+        pool.task = &task;
+        pool.taskCount = count;
+        pool.nextTask.store(0);
+        pool.running = pool.workerCount;
+        pool.error = nullptr;
+        ++pool.generation;
+    }
+    pool.wake.notify_all();
+
+    insideJob = true;
+    pool.drain();
+    insideJob = false;
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> guard(pool.lock);
+        pool.done.wait(guard, [&] { return pool.running == 0; });
+        pool.task = nullptr;
+        error = pool.error;
+        pool.error = nullptr;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}
@@ -3,6 +3,23 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "SquareMatrix.hpp"
+#include "FixedSquareMatrix.hpp"
+#include "MatrixArena.hpp"
+#include "BufferPool.hpp"
+#include "SimdKernels.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+#include "SquareMatrixBatch.hpp"
+#include "MixedPrecision.hpp"
+#include "LinearRecurrence.hpp"
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
 
 using namespace operators;
 
@@ -437,4 +454,1211 @@ TEST_CASE("Matrix determinant") {
     double det = !mat;
 
     CHECK(det == 14);
-} 
\ No newline at end of file
+} 
+
+/**
+ * Test case for contiguous storage
+ * Verifies that rows are laid out back-to-back and survive copying and assignment
+ */
+TEST_CASE("Contiguous row storage") {
+    SquareMat mat(3);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            mat[i][j] = i * 3 + j;
+
+    CHECK(mat[1] == mat[0] + mat.getStride());
+    CHECK(mat[2] == mat[0] + 2 * mat.getStride());
+
+    SquareMat copy(mat);
+    SquareMat assigned(2);
+    assigned = mat;
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            CHECK(copy[i][j] == i * 3 + j);
+            CHECK(assigned[i][j] == i * 3 + j);
+        }
+    }
+    CHECK(copy[0] != mat[0]);
+}
+
+
+/**
+ * Test case for move semantics and buffer reuse
+ * Verifies that moves transfer the buffer and same-size assignment keeps it
+ */
+TEST_CASE("Move semantics and buffer reuse") {
+    SquareMat mat(8); // Above SMALL_SIZE, so the buffer lives on the heap
+    mat[0][0] = 1; mat[0][1] = 2;
+    mat[1][0] = 3; mat[1][1] = 4;
+    const double* buffer = mat[0];
+
+    SquareMat moved(std::move(mat));
+    CHECK(moved[0] == buffer);
+    CHECK(moved[1][1] == 4);
+
+    SquareMat target(8);
+    const double* targetBuffer = target[0];
+    target = moved; // Same size: copy into the existing buffer
+    CHECK(target[0] == targetBuffer);
+    CHECK(target[1][0] == 3);
+
+    SquareMat other(9);
+    other = std::move(moved);
+    CHECK(other[0] == buffer);
+    CHECK(other[0][1] == 2);
+
+    SquareMat a(8), b(3);
+    a[0][0] = 7;
+    b[2][2] = 5;
+    swap(a, b);
+    CHECK(b[0][0] == 7);
+    CHECK(a[2][2] == 5);
+    CHECK_THROWS_AS(a[3], std::out_of_range);
+}
+
+/**
+ * Test case for aligned, padded storage
+ * Verifies row alignment and that power-of-two sizes get a non-power-of-two stride
+ */
+TEST_CASE("Aligned storage with padded stride") {
+    for (int n : {5, 8, 9, 128, 512}) {
+        SquareMat mat(n);
+        CHECK(mat.getSize() == n);
+        CHECK(mat.getStride() >= n);
+        for (int i = 0; i < n; ++i) {
+            CHECK(reinterpret_cast<std::uintptr_t>(mat[i]) % SquareMat::CACHE_LINE == 0);
+        }
+    }
+    CHECK(SquareMat(512).getStride() % 512 != 0);
+
+    SquareMat mat(9);
+    mat.rawData()[2 * mat.getStride() + 5] = 42;
+    CHECK(mat[2][5] == 42);
+}
+
+/**
+ * Test case for element accessors
+ * Verifies that at() checks its indices and operator() reaches the same elements
+ */
+TEST_CASE("Element accessors") {
+    SquareMat mat(2);
+    mat(0, 1) = 5;
+    mat.at(1, 0) = 7;
+
+    CHECK(mat[0][1] == 5);
+    CHECK(mat.at(0, 1) == 5);
+    CHECK(mat(1, 0) == 7);
+
+    const SquareMat& view = mat;
+    CHECK(view(0, 1) == 5);
+    CHECK(view.at(1, 0) == 7);
+
+    CHECK_THROWS_AS(mat.at(2, 0), std::out_of_range);
+    CHECK_THROWS_AS(mat.at(0, -1), std::out_of_range);
+    CHECK_THROWS_AS(view.at(-1, 1), std::out_of_range);
+}
+
+/**
+ * Test case for uninitialized construction
+ * Verifies that the factory validates its size and yields a usable matrix once filled
+ */
+TEST_CASE("Uninitialized factory") {
+    SquareMat mat = SquareMat::uninitialized(3);
+    CHECK(mat.getSize() == 3);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            mat(i, j) = i == j ? 2 : 0;
+
+    CHECK(!mat == 8);
+    CHECK(sumElements(mat * mat) == 12);
+    CHECK_THROWS_AS(SquareMat::uninitialized(0), std::invalid_argument);
+}
+
+/**
+ * Test case for the scoped arena
+ * Verifies that temporaries come from the arena and results assigned outside the scope survive it
+ */
+TEST_CASE("Scoped matrix arena") {
+    SquareMat a(2), b(2);
+    a[0][0] = 1; a[0][1] = 2;
+    a[1][0] = 3; a[1][1] = 4;
+    b[0][0] = 1; b[1][1] = 1;
+
+    SquareMat keep(2);
+    const double* keepBuffer = keep[0];
+    CHECK(MatrixArena::current() == nullptr);
+    {
+        MatrixArena scope(4096);
+        CHECK(MatrixArena::current() == &scope);
+
+        SquareMat sum = a + b;
+        SquareMat wide(8); // Above SMALL_SIZE, so it draws from the arena
+        CHECK(scope.reservedBytes() > 0);
+        {
+            MatrixArena inner;
+            CHECK(MatrixArena::current() == &inner);
+        }
+        CHECK(MatrixArena::current() == &scope);
+
+        keep = (sum * (a - b)) ^ 2; // Copied into keep's own heap buffer
+        SquareMat big(100);         // Larger than half a block: dedicated block
+        big[99][99] = 1;
+        CHECK(sumElements(big) == 1);
+    }
+    CHECK(MatrixArena::current() == nullptr);
+    CHECK(keep[0] == keepBuffer);
+    CHECK(keep[0][0] == 186);
+    CHECK(keep[0][1] == 270);
+    CHECK(keep[1][0] == 405);
+    CHECK(keep[1][1] == 591);
+}
+
+/**
+ * Test case for the buffer pool
+ * Verifies that freed buffers are recycled, the cap is honored and trimming empties the pool
+ */
+TEST_CASE("Buffer pool recycling") {
+#ifndef MATRIX_NO_POOL
+    const std::size_t oldCapacity = BufferPool::capacity();
+    BufferPool::trim();
+    CHECK(BufferPool::cachedBytes() == 0);
+
+    const double* first;
+    {
+        SquareMat mat(50);
+        first = mat[0];
+    }
+    CHECK(BufferPool::cachedBytes() > 0);
+    {
+        SquareMat again(50); // Same size class: the cached buffer comes back
+        CHECK(again[0] == first);
+        CHECK(again[49][49] == 0);
+    }
+
+    BufferPool::setCapacity(1024); // Too small to keep a 50x50 buffer
+    CHECK(BufferPool::cachedBytes() <= 1024);
+    { SquareMat mat(50); }
+    CHECK(BufferPool::cachedBytes() <= 1024);
+
+    BufferPool::setCapacity(oldCapacity);
+    { SquareMat mat(50); }
+    CHECK(BufferPool::cachedBytes() > 0);
+    BufferPool::trim();
+    CHECK(BufferPool::cachedBytes() == 0);
+#endif
+}
+
+/**
+ * Test case for inline storage of small matrices
+ * Verifies that small matrices live inside the object and behave across copies, moves and swaps
+ */
+TEST_CASE("Inline small-matrix storage") {
+    SquareMat small(SquareMat::SMALL_SIZE);
+    const char* object = reinterpret_cast<const char*>(&small);
+    const char* elements = reinterpret_cast<const char*>(small.rawData());
+    CHECK(elements >= object);
+    CHECK(elements < object + sizeof(SquareMat));
+    CHECK(small.getStride() == SquareMat::SMALL_SIZE);
+    CHECK(reinterpret_cast<std::uintptr_t>(small.rawData()) % SquareMat::CACHE_LINE == 0);
+
+    small(3, 3) = 9;
+    SquareMat copy(small);
+    SquareMat moved(std::move(small));
+    CHECK(copy(3, 3) == 9);
+    CHECK(moved(3, 3) == 9);
+
+    SquareMat tiny(2);
+    tiny(1, 1) = 4;
+    moved = std::move(tiny); // Inline to inline, different sizes
+    CHECK(moved.getSize() == 2);
+    CHECK(moved(1, 1) == 4);
+
+    SquareMat large(6);
+    large(5, 5) = 1;
+    swap(moved, large); // Inline and heap storage trade places
+    CHECK(moved(5, 5) == 1);
+    CHECK(large(1, 1) == 4);
+    CHECK(large.getSize() == 2);
+}
+
+/**
+ * Test case for the element-type template
+ * Verifies float, exact 64-bit integer and complex matrices
+ */
+TEST_CASE("Element types") {
+    FloatSquareMat f(2);
+    f[0][0] = 1.5f; f[0][1] = 2;
+    f[1][0] = 3;    f[1][1] = 4;
+    FloatSquareMat fProd = f * f;
+    CHECK(fProd[0][0] == doctest::Approx(8.25));
+    CHECK(!f == doctest::Approx(0));
+
+    IntSquareMat big(2);
+    big[0][0] = 3000000001LL; big[0][1] = 7;
+    big[1][0] = -9;            big[1][1] = 1;
+    IntSquareMat reduced = big % 3;
+    CHECK(reduced[0][0] == 3000000001LL % 3); // Exceeds int, must not be narrowed
+    CHECK(reduced[1][0] == 0);
+    CHECK((big * big)[0][1] == 3000000001LL * 7 + 7);
+    CHECK(sumElements(big) == 3000000000LL);
+
+    ComplexSquareMat c(2);
+    const std::complex<double> i(0, 1);
+    c[0][0] = i; c[1][1] = i;
+    ComplexSquareMat square = c * c;
+    CHECK(square[0][0] == std::complex<double>(-1, 0));
+    CHECK(!c == std::complex<double>(-1, 0));
+    CHECK((2.0 * c)[1][1] == std::complex<double>(0, 2));
+    CHECK(c < square * 3.0);
+    CHECK(c == ~c);
+}
+
+/**
+ * Test case for compile-time sized matrices
+ * Verifies the unrolled kernels against SquareMat and conversion in both directions
+ */
+TEST_CASE("Fixed-size matrices") {
+    SquareMat dynamic(3);
+    dynamic[0][0] = 2; dynamic[0][1] = 0; dynamic[0][2] = 1;
+    dynamic[1][0] = 0; dynamic[1][1] = 1; dynamic[1][2] = 0;
+    dynamic[2][0] = 1; dynamic[2][1] = 0; dynamic[2][2] = 2;
+
+    FixedSquareMat<3> fixed(dynamic);
+    SquareMat product = fixed * fixed; // Converted back implicitly
+    SquareMat expected = dynamic * dynamic;
+    SquareMat powered = fixed ^ 5;
+    SquareMat expectedPower = dynamic ^ 5;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            CHECK(product[i][j] == expected[i][j]);
+            CHECK(powered[i][j] == expectedPower[i][j]);
+            CHECK((~fixed)(i, j) == dynamic[j][i]);
+        }
+    }
+    CHECK(!fixed == !dynamic);
+    CHECK((fixed ^ 0) == FixedSquareMat<3>::identity());
+    SquareMat inversePower = fixed ^ -2;
+    SquareMat expectedInversePower = dynamic ^ -2;
+    bool close = true;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            close = close && std::abs(inversePower[i][j] - expectedInversePower[i][j]) < 1e-12;
+    CHECK(close);
+    CHECK_THROWS_AS(FixedSquareMat<3>() ^ -1, std::invalid_argument); // Singular
+    CHECK_THROWS_AS(FixedSquareMat<2>{dynamic}, std::invalid_argument);
+    CHECK_THROWS_AS(fixed.at(3, 0), std::out_of_range);
+
+    FixedSquareMat<6, std::int64_t> big;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            big(i, j) = (i * 7 + j * 3) % 5 + (i == j ? 4 : 0);
+    CHECK(!big == !static_cast<IntSquareMat>(big)); // Bareiss vs cofactor expansion
+    CHECK_THROWS_AS(big ^ -1, std::invalid_argument);
+
+    FixedSquareMat<2> a;
+    a(0, 0) = 1; a(0, 1) = 2; a(1, 0) = 3; a(1, 1) = 4;
+    FixedSquareMat<2> b = 2.0 * a - a;
+    b += a;
+    b %= a;
+    CHECK(b(1, 1) == 32);
+    CHECK(sumElements(a % 3) == 1 + 2 + 0 + 1);
+}
+
+/**
+ * Memory resource that counts the bytes it hands out, for the allocator hook test
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t live = 0;
+    int allocations = 0;
+    int deallocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        live += bytes;
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        live -= bytes;
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * Test case for the memory resource hook
+ * Verifies that storage comes from the given resource and that operator results inherit it
+ */
+TEST_CASE("Pluggable memory resource") {
+    CountingResource counting;
+    {
+        SquareMat a(8, &counting), b(8, &counting);
+        a(0, 0) = 2; b(0, 0) = 3;
+        CHECK(counting.allocations == 2);
+        CHECK(a.getResource() == &counting);
+
+        SquareMat product = a * b + a;
+        CHECK(product.getResource() == &counting);
+        CHECK(product(0, 0) == 8);
+        CHECK(counting.allocations == 4);
+
+        SquareMat copy(product); // Plain copies go to the default (buffer pool)
+        CHECK(copy.getResource() == nullptr);
+        SquareMat placed(copy, &counting);
+        CHECK(placed.getResource() == &counting);
+
+        SquareMat pooled(8);
+        pooled = std::move(placed); // Different resources: copied, pooled keeps its own buffer
+        CHECK(pooled.getResource() == nullptr);
+        CHECK(pooled(0, 0) == 8);
+
+        SquareMat small(3, &counting); // Inline, never calls the resource
+        CHECK(counting.allocations == 5);
+
+        {
+            SquareMat source(8, &counting);
+            SquareMat moved(std::move(source));
+        }
+        CHECK(counting.allocations == counting.deallocations + 4); // The moved-from source freed nothing
+    }
+    CHECK(counting.live == 0);
+    CHECK(counting.deallocations == counting.allocations);
+
+    {
+        MatrixArena scope;
+        SquareMat inArena(8);
+        CHECK(inArena.getResource() == &scope);
+    }
+}
+
+/**
+ * Fills a matrix with small integers so that products are exact in floating point
+ */
+template <typename Mat>
+static void fillPattern(Mat& mat, int seed) {
+    const int n = mat.getSize();
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            mat(i, j) = (i * 31 + j * 17 + seed * 7) % 11 - 5;
+}
+
+/**
+ * Textbook triple loop used as the reference for the optimized products
+ */
+template <typename Mat>
+static Mat naiveProduct(const Mat& a, const Mat& b) {
+    const int n = a.getSize();
+    Mat result(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            for (int k = 0; k < n; ++k)
+                result(i, j) += a(i, k) * b(k, j);
+    return result;
+}
+
+/**
+ * Element-by-element comparison (operator== only compares sums)
+ */
+template <typename Mat>
+static bool sameElements(const Mat& a, const Mat& b) {
+    const int n = a.getSize();
+    bool same = n == b.getSize();
+    for (int i = 0; same && i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            same = same && a(i, j) == b(i, j);
+    return same;
+}
+
+/**
+ * Test case for the blocked matrix product
+ * Verifies sizes that cross the direct-loop limit, micro-tile edges and every blocking level
+ */
+TEST_CASE("Blocked matrix multiplication") {
+    for (int n : {5, 47, 49, 97, 130, 300}) {
+        SquareMat a(n), b(n);
+        fillPattern(a, 1);
+        fillPattern(b, 2);
+        SquareMat expected = naiveProduct(a, b);
+        SquareMat product = a * b;
+        bool same = true;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                same = same && product(i, j) == expected(i, j);
+        CHECK_MESSAGE(same, "size ", n);
+    }
+
+    IntSquareMat a(70), b(70);
+    fillPattern(a, 3);
+    fillPattern(b, 4);
+    IntSquareMat expected = naiveProduct(a, b);
+    IntSquareMat expectedSquare = naiveProduct(a, a);
+    IntSquareMat squared = a ^ 2;
+    IntSquareMat product = a * b;
+    a *= b;
+    bool same = true;
+    for (int i = 0; i < 70; ++i)
+        for (int j = 0; j < 70; ++j)
+            same = same && product(i, j) == expected(i, j) && a(i, j) == expected(i, j) &&
+                   squared(i, j) == expectedSquare(i, j);
+    CHECK(same);
+}
+
+/**
+ * Test case for the instruction set dispatch
+ * Runs the products and the elementwise kernels on every instruction set the CPU supports
+ * and checks each against the portable reference, including partial tiles and row tails
+ */
+TEST_CASE("Instruction set dispatch") {
+    const kernels::Isa original = kernels::activeIsa();
+    CHECK(kernels::isaSupported(kernels::Isa::Scalar));
+    CHECK(kernels::isaSupported(original));
+
+    for (kernels::Isa isa : {kernels::Isa::Scalar, kernels::Isa::Sse2, kernels::Isa::Avx2, kernels::Isa::Avx512}) {
+        if (!kernels::setIsa(isa))
+            continue;
+        CHECK(kernels::activeIsa() == isa);
+
+        for (int n : {97, 130}) {
+            SquareMat a(n), b(n);
+            fillPattern(a, 1);
+            fillPattern(b, 2);
+            CHECK_MESSAGE(sameElements(a * b, naiveProduct(a, b)), kernels::isaName(isa), " size ", n);
+        }
+        FloatSquareMat fa(83), fb(83);
+        fillPattern(fa, 5);
+        fillPattern(fb, 6);
+        CHECK_MESSAGE(sameElements(fa * fb, naiveProduct(fa, fb)), kernels::isaName(isa));
+
+        const int n = 37;
+        SquareMat a(n), b(n);
+        fillPattern(a, 7);
+        fillPattern(b, 8);
+        SquareMat sum = a + b, difference = a - b, hadamard = a % b, scaled = a * 2.5;
+        SquareMat accumulated(a);
+        accumulated += b;
+        double total = 0;
+        bool same = true;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                same = same && sum(i, j) == a(i, j) + b(i, j) && difference(i, j) == a(i, j) - b(i, j) &&
+                       hadamard(i, j) == a(i, j) * b(i, j) && scaled(i, j) == a(i, j) * 2.5 &&
+                       accumulated(i, j) == sum(i, j);
+                total += a(i, j);
+            }
+        CHECK_MESSAGE(same, kernels::isaName(isa));
+        CHECK(sumElements(a) == total);
+
+        FloatSquareMat fs = fa + fb;
+        float floatTotal = 0;
+        for (int i = 0; i < 83; ++i)
+            for (int j = 0; j < 83; ++j)
+                floatTotal += fs(i, j);
+        CHECK(fs(82, 81) == fa(82, 81) + fb(82, 81));
+        CHECK(sumElements(fs) == floatTotal);
+
+        // Multiply-add behind the batched product, with a tail shorter than every vector width
+        double out[37];
+        float floatOut[37];
+        for (int j = 0; j < n; ++j) {
+            out[j] = 1.0;
+            floatOut[j] = 1.0f;
+        }
+        kernels::mulAddRow(n, a.rawData(), b.rawData(), out);
+        kernels::mulAddRow(n, fa.rawData(), fb.rawData(), floatOut);
+        bool fused = true;
+        for (int j = 0; j < n; ++j)
+            fused = fused && out[j] == 1.0 + a(0, j) * b(0, j) && floatOut[j] == 1.0f + fa(0, j) * fb(0, j);
+        CHECK_MESSAGE(fused, kernels::isaName(isa));
+    }
+
+    kernels::setIsa(original);
+}
+
+/**
+ * Test case for Strassen-Winograd multiplication
+ * Lowers the crossover so small matrices recurse, covering even splits, odd sizes that
+ * peel a row and column, general alpha and beta, and turning the recursion off
+ */
+TEST_CASE("Strassen-Winograd multiplication") {
+    const int original = kernels::strassenCrossover();
+    kernels::setStrassenCrossover(64);
+    CHECK(kernels::strassenCrossover() == 64);
+
+    for (int n : {64, 130, 131, 255}) {
+        SquareMat a(n), b(n);
+        fillPattern(a, 1);
+        fillPattern(b, 2);
+        CHECK_MESSAGE(sameElements(a * b, naiveProduct(a, b)), "size ", n);
+    }
+
+    FloatSquareMat fa(97), fb(97);
+    fillPattern(fa, 3);
+    fillPattern(fb, 4);
+    CHECK(sameElements(fa * fb, naiveProduct(fa, fb)));
+
+    ComplexSquareMat ca(67), cb(67);
+    fillPattern(ca, 5);
+    fillPattern(cb, 6);
+    ca(3, 4) = std::complex<double>(2, -1);
+    CHECK(sameElements(ca * cb, naiveProduct(ca, cb)));
+
+    // C = 2 * A * B - C
+    SquareMat a(101), b(101), c(101);
+    fillPattern(a, 7);
+    fillPattern(b, 8);
+    fillPattern(c, 9);
+    SquareMat expected = naiveProduct(a, b) * 2.0 - c;
+    kernels::gemm(101, 2.0, a.rawData(), a.getStride(), b.rawData(), b.getStride(), -1.0, c.rawData(),
+                  c.getStride());
+    CHECK(sameElements(c, expected));
+
+    // Integers never take the Strassen path
+    IntSquareMat ia(99), ib(99);
+    fillPattern(ia, 10);
+    fillPattern(ib, 11);
+    CHECK(sameElements(ia * ib, naiveProduct(ia, ib)));
+
+    kernels::setStrassenCrossover(0);
+    CHECK(kernels::strassenCrossover() == 0);
+    SquareMat x(300), y(300);
+    fillPattern(x, 12);
+    fillPattern(y, 13);
+    x(0, 0) = 0.1;
+    SquareMat classical = x * y;
+    kernels::setStrassenCrossover(64);
+    SquareMat fast = x * y;
+    kernels::setStrassenCrossover(0);
+    CHECK(sameElements(x * y, classical));
+    CHECK(std::abs(fast(0, 5) - classical(0, 5)) < 1e-9);
+
+    // MATRIX_STRASSEN is clamped like setStrassenCrossover: negative turns the recursion off
+    const char* environment = std::getenv("MATRIX_STRASSEN");
+    const std::string saved = environment ? environment : "";
+    setenv("MATRIX_STRASSEN", "-1", 1);
+    kernels::resetStrassenCrossover();
+    CHECK(kernels::strassenCrossover() == 0);
+    CHECK(sameElements(x * y, classical));
+    setenv("MATRIX_STRASSEN", "96", 1);
+    kernels::resetStrassenCrossover();
+    CHECK(kernels::strassenCrossover() == 96);
+    unsetenv("MATRIX_STRASSEN");
+    kernels::resetStrassenCrossover();
+    CHECK(kernels::strassenCrossover() == 2048);
+    if (environment)
+        setenv("MATRIX_STRASSEN", saved.c_str(), 1);
+
+    kernels::setStrassenCrossover(original);
+}
+
+/**
+ * Test case for the thread pool
+ * Verifies every task runs exactly once, nested jobs run inline and task errors reach the caller
+ */
+TEST_CASE("Thread pool") {
+    const int original = ThreadPool::threadCount();
+    CHECK(original >= 1);
+    ThreadPool::setThreadCount(4);
+    CHECK(ThreadPool::threadCount() == 4);
+
+    std::atomic<int> hits[100];
+    for (std::atomic<int>& hit : hits)
+        hit = 0;
+    std::atomic<int> nested(0);
+    ThreadPool::parallelFor(100, [&](int index) {
+        ++hits[index];
+        ThreadPool::parallelFor(3, [&](int) { ++nested; });
+    });
+    bool once = true;
+    for (std::atomic<int>& hit : hits)
+        once = once && hit == 1;
+    CHECK(once);
+    CHECK(nested == 300);
+
+    CHECK_THROWS_AS(ThreadPool::parallelFor(10,
+                                            [](int index) {
+                                                if (index == 7)
+                                                    throw std::runtime_error("task failed");
+                                            }),
+                    std::runtime_error);
+
+    ThreadPool::setThreadCount(0);
+    CHECK(ThreadPool::threadCount() >= 1);
+    ThreadPool::setThreadCount(original);
+}
+
+/**
+ * Test case for the multithreaded matrix product
+ * Uses more threads than tiles fit evenly so some tiles are partial or empty
+ */
+TEST_CASE("Multithreaded matrix multiplication") {
+    const int original = ThreadPool::threadCount();
+    for (int threads : {2, 3, 6}) {
+        ThreadPool::setThreadCount(threads);
+        for (int n : {256, 301}) {
+            SquareMat a(n), b(n);
+            fillPattern(a, 1);
+            fillPattern(b, 2);
+            SquareMat expected = naiveProduct(a, b);
+            CHECK_MESSAGE(sameElements(a * b, expected), threads, " threads, size ", n);
+            a *= b;
+            CHECK_MESSAGE(sameElements(a, expected), threads, " threads, size ", n);
+        }
+    }
+    IntSquareMat ia(260);
+    fillPattern(ia, 3);
+    CHECK(sameElements(ia ^ 2, naiveProduct(ia, ia)));
+    ThreadPool::setThreadCount(original);
+}
+
+/**
+ * Test case for the in-place product
+ * Verifies accumulation into an existing matrix, operands aliasing the destination,
+ * size checks, and that a matrix outliving an arena scope keeps its own storage
+ */
+TEST_CASE("In-place matrix product") {
+    const int n = 70;
+    SquareMat a(n), b(n), acc(n);
+    fillPattern(a, 1);
+    fillPattern(b, 2);
+    fillPattern(acc, 3);
+    const SquareMat product = naiveProduct(a, b);
+    const SquareMat start(acc);
+
+    gemm(1.0, a, b, 1.0, acc);
+    CHECK(sameElements(acc, start + product));
+
+    gemm(1.0, a, b, 0.5, acc);
+    CHECK(sameElements(acc, (start + product) * 0.5 + product));
+
+    const double* storage = acc.rawData();
+    gemm(2.0, a, b, 0.0, acc);
+    CHECK(sameElements(acc, product * 2.0));
+    CHECK(acc.rawData() == storage);
+
+    SquareMat x(a);
+    gemm(1.0, x, b, 1.0, x); // x = x * b + x
+    CHECK(sameElements(x, product + a));
+    SquareMat y(a);
+    gemm(1.0, y, y, 0.0, y);
+    CHECK(sameElements(y, naiveProduct(a, a)));
+
+    SquareMat wrong(3);
+    CHECK_THROWS_AS(gemm(1.0, a, b, 0.0, wrong), std::invalid_argument);
+
+    SquareMat outer(a);
+    {
+        MatrixArena scope;
+        outer *= b;
+        CHECK(outer.getResource() == nullptr);
+    }
+    CHECK(sameElements(outer, product));
+
+    ComplexSquareMat c(6), d(6), e(6);
+    fillPattern(c, 4);
+    fillPattern(d, 5);
+    gemm(std::complex<double>(0, 1), c, d, std::complex<double>(0), e);
+    CHECK(sameElements(e, naiveProduct(c, d) * std::complex<double>(0, 1)));
+}
+
+/**
+ * Test case for the transpose-fused products
+ * Compares A * ~B and ~A * B with the materialized transpose on the direct, blocked,
+ * multithreaded and Strassen paths, including odd sizes
+ */
+TEST_CASE("Transpose-fused products") {
+    const int originalThreads = ThreadPool::threadCount();
+    const int originalCrossover = kernels::strassenCrossover();
+    kernels::setStrassenCrossover(0);
+    for (int n : {3, 40, 97, 300}) {
+        SquareMat a(n), b(n);
+        fillPattern(a, 1);
+        fillPattern(b, 2);
+        CHECK_MESSAGE(sameElements(a.multiplyTransposed(b), naiveProduct(a, ~b)), "size ", n);
+        CHECK_MESSAGE(sameElements(a.transposedMultiply(b), naiveProduct(~a, b)), "size ", n);
+    }
+
+    ThreadPool::setThreadCount(3);
+    FloatSquareMat fa(263), fb(263);
+    fillPattern(fa, 3);
+    fillPattern(fb, 4);
+    CHECK(sameElements(fa.multiplyTransposed(fb), naiveProduct(fa, ~fb)));
+    CHECK(sameElements(fa.transposedMultiply(fb), naiveProduct(~fa, fb)));
+    ThreadPool::setThreadCount(originalThreads);
+
+    kernels::setStrassenCrossover(32);
+    for (int n : {64, 129}) {
+        SquareMat a(n), b(n);
+        fillPattern(a, 5);
+        fillPattern(b, 6);
+        a(1, 0) = 9; // Make A visibly non-symmetric
+        CHECK_MESSAGE(sameElements(a.multiplyTransposed(b), naiveProduct(a, ~b)), "size ", n);
+        CHECK_MESSAGE(sameElements(a.transposedMultiply(b), naiveProduct(~a, b)), "size ", n);
+        SquareMat c(n);
+        kernels::gemm(kernels::Transpose::Yes, kernels::Transpose::Yes, n, 1.0, a.rawData(), a.getStride(),
+                      b.rawData(), b.getStride(), 0.0, c.rawData(), c.getStride());
+        CHECK_MESSAGE(sameElements(c, naiveProduct(~a, ~b)), "size ", n);
+    }
+    kernels::setStrassenCrossover(originalCrossover);
+
+    IntSquareMat ia(5), ib(4);
+    CHECK_THROWS_AS(ia.multiplyTransposed(ib), std::invalid_argument);
+    CHECK_THROWS_AS(ia.transposedMultiply(ib), std::invalid_argument);
+}
+
+/**
+ * Test case for the symmetric rank-k product
+ * Checks gram() against the full product on the direct, tiled and multithreaded paths,
+ * and that the raw kernel leaves the other triangle untouched
+ */
+TEST_CASE("Symmetric rank-k product") {
+    const int originalThreads = ThreadPool::threadCount();
+    for (int n : {5, 48, 100, 193, 400}) {
+        SquareMat a(n);
+        fillPattern(a, 1);
+        a(n - 1, 0) = 3.5;
+        SquareMat g = a.gram();
+        CHECK_MESSAGE(sameElements(g, naiveProduct(a, ~a)), "size ", n);
+        CHECK_MESSAGE(sameElements(a.multiplyTransposed(a), g), "size ", n);
+    }
+
+    ThreadPool::setThreadCount(4);
+    ComplexSquareMat ca(300);
+    fillPattern(ca, 2);
+    ca(7, 3) = std::complex<double>(1, 2);
+    CHECK(sameElements(ca.gram(), naiveProduct(ca, ~ca)));
+    ThreadPool::setThreadCount(originalThreads);
+
+    // Upper triangle with alpha and beta; the strict lower triangle keeps its sentinel
+    for (int n : {30, 250}) {
+        SquareMat a(n), c(n);
+        fillPattern(a, 3);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                c(i, j) = j >= i ? 1.0 : -77.0;
+        kernels::syrk(kernels::Triangle::Upper, n, 2.0, a.rawData(), a.getStride(), 3.0, c.rawData(),
+                      c.getStride());
+        const SquareMat full = naiveProduct(a, ~a);
+        bool same = true;
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                same = same && c(i, j) == (j >= i ? 2.0 * full(i, j) + 3.0 : -77.0);
+        CHECK_MESSAGE(same, "size ", n);
+    }
+}
+
+/**
+ * Test case for the structure-of-arrays batch
+ * Each batched operator must agree with the same operator applied to every matrix;
+ * the counts cross the slice width of the batched product and determinant
+ */
+TEST_CASE("Matrix batch") {
+    for (int n : {1, 3, 4, 6}) {
+        std::vector<IntSquareMat> left, right;
+        for (int index = 0; index < 600; ++index) {
+            IntSquareMat a(n), b(n);
+            fillPattern(a, index);
+            fillPattern(b, index * 3 + 1);
+            a(n - 1, 0) += index % 7; // Keep some determinants non-zero
+            left.push_back(a);
+            right.push_back(b);
+        }
+        const IntSquareMatBatch x(left), y(right);
+        CHECK(x.getSize() == n);
+        CHECK(x.getCount() == 600);
+
+        const IntSquareMatBatch sum = x + y, difference = x - y, product = x * y, scaled = x * 3;
+        const IntSquareMatBatch transposed = ~x, cube = x ^ 3, identity = x ^ 0;
+        const std::vector<std::int64_t> determinants = !x;
+        bool same = true;
+        for (int index = 0; index < 600; ++index) {
+            const IntSquareMat& a = left[index];
+            const IntSquareMat& b = right[index];
+            same = same && sameElements(sum.get(index), a + b) && sameElements(difference.get(index), a - b);
+            same = same && sameElements(product.get(index), a * b) && sameElements(scaled.get(index), a * 3);
+            same = same && sameElements(transposed.get(index), ~a) && sameElements(cube.get(index), a ^ 3);
+            same = same && sameElements(identity.get(index), a ^ 0) && determinants[index] == !a;
+        }
+        CHECK_MESSAGE(same, "size ", n);
+    }
+
+    // Floating point, and the one-by-one determinant above BATCH_DETERMINANT_LIMIT
+    std::vector<SquareMat> matrices;
+    for (int index = 0; index < 5; ++index) {
+        SquareMat a(9);
+        fillPattern(a, index);
+        a(index, 2) += 0.5;
+        matrices.push_back(a);
+    }
+    const SquareMatBatch batch(matrices);
+    const std::vector<double> determinants = !batch;
+    const std::vector<SquareMat> squares = (batch * batch).toMatrices();
+    for (int index = 0; index < 5; ++index) {
+        CHECK(determinants[index] == doctest::Approx(!matrices[index]));
+        CHECK(sameElements(squares[index], naiveProduct(matrices[index], matrices[index])));
+    }
+
+    // Element access and conversions
+    SquareMatBatch zeros(2, 3);
+    zeros(1, 0, 1) = 4.0;
+    CHECK(zeros.get(1)(0, 1) == 4.0);
+    SquareMat small(2);
+    small(1, 1) = -2.0;
+    zeros.set(2, small);
+    CHECK(sameElements(zeros.toMatrices()[2], small));
+    CHECK_THROWS_AS(zeros.get(3), std::out_of_range);
+    CHECK_THROWS_AS(zeros.set(0, SquareMat(3)), std::invalid_argument);
+    CHECK_THROWS_AS(zeros + batch, std::invalid_argument);
+    CHECK_THROWS_AS(zeros + SquareMatBatch(2, 4), std::invalid_argument);
+    CHECK_THROWS_AS(batch ^ -1, std::invalid_argument);
+    CHECK_THROWS_AS(SquareMatBatch(std::vector<SquareMat>()), std::invalid_argument);
+    CHECK_THROWS_AS(SquareMatBatch(std::vector<SquareMat>{SquareMat(2), SquareMat(3)}), std::invalid_argument);
+}
+
+/**
+ * Test case for the GEMM blocking overrides and the tuning profile
+ * Odd block sizes must still give exact products, and a saved profile must load back
+ */
+TEST_CASE("GEMM tuning profile") {
+    const kernels::GemmBlocking builtIn = kernels::gemmBlocking<double>();
+    const int mr = kernels::microKernel<double>().mr;
+
+    kernels::setGemmBlocking<double>({mr * 3 + 1, 37, 50});
+    const kernels::GemmBlocking tuned = kernels::gemmBlocking<double>();
+    CHECK(tuned.mc == mr * 3);
+    CHECK(tuned.kc == 37);
+    CHECK(tuned.nc % kernels::microKernel<double>().nr == 0);
+    SquareMat a(130), b(130);
+    fillPattern(a, 1);
+    fillPattern(b, 2);
+    CHECK(sameElements(a * b, naiveProduct(a, b)));
+
+    // Only kc overridden for float; the other fields keep the built-in sizes
+    const kernels::GemmBlocking floatBuiltIn = kernels::gemmBlocking<float>();
+    kernels::setGemmBlocking<float>({0, 64, 0});
+    CHECK(kernels::gemmBlocking<float>().mc == floatBuiltIn.mc);
+    CHECK(kernels::gemmBlocking<float>().kc == 64);
+
+    const char* path = "gemm_tuning_test.profile";
+    REQUIRE(kernels::saveTuningProfile(path));
+    kernels::setGemmBlocking<double>({0, 0, 0});
+    kernels::setGemmBlocking<float>({0, 0, 0});
+    CHECK(kernels::gemmBlocking<double>().kc == builtIn.kc);
+    CHECK(kernels::loadTuningProfile(path));
+    CHECK(kernels::gemmBlocking<double>().kc == 37);
+    CHECK(kernels::gemmBlocking<double>().mc == mr * 3);
+    CHECK(kernels::gemmBlocking<float>().kc == 64);
+    std::remove(path);
+
+    CHECK_FALSE(kernels::loadTuningProfile("no_such_directory/gemm.tuning"));
+    kernels::setGemmBlocking<double>({0, 0, 0});
+    kernels::setGemmBlocking<float>({0, 0, 0});
+    CHECK(kernels::gemmBlocking<double>().mc == builtIn.mc);
+    CHECK(kernels::gemmBlocking<double>().nc == builtIn.nc);
+}
+
+/**
+ * Test case for mixed-precision products and solves
+ * Products must stay within float accuracy across the depth slices and the thread pool,
+ * and solves must refine to double accuracy, falling back for ill-conditioned systems
+ */
+TEST_CASE("Mixed precision") {
+    const int n = 300;
+    SquareMat a(n), b(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            a(i, j) = std::sin(i * 7.0 + j * 3.0);
+            b(i, j) = std::cos(i * 5.0 - j * 2.0) + (i == j ? 3.0 : 0.0);
+        }
+    CHECK(productResidual(a, b, naiveProduct(a, b)) < 1e-13);
+
+    double residual = -1;
+    SquareMat mixed = multiplyMixed(a, b, &residual);
+    CHECK(residual > 0);
+    CHECK(residual < 1e-5);
+    CHECK(std::abs(mixed(17, 250) - naiveProduct(a, b)(17, 250)) < 1e-4);
+
+    {
+        MixedPrecisionScope scope;
+        CHECK(MixedPrecisionScope::current() == &scope);
+        SquareMat product = a * b;
+        CHECK(scope.products() == 1);
+        CHECK(scope.lastResidual() == doctest::Approx(productResidual(a, b, product)));
+        {
+            MixedPrecisionScope inner;
+            SquareMat square = b * b;
+            CHECK(inner.products() == 1);
+            CHECK(inner.worstResidual() < 1e-5);
+        }
+        CHECK(scope.products() == 1);
+        IntSquareMat ia(4);
+        ia = ia * ia; // Other element types keep their exact product
+        CHECK(scope.products() == 1);
+    }
+    CHECK(MixedPrecisionScope::current() == nullptr);
+    CHECK(productResidual(a, b, a * b) < 1e-13);
+
+    // Diagonally dominant system: float factors plus refinement reach double accuracy
+    SquareMat system(120), rhs(120);
+    for (int i = 0; i < 120; ++i)
+        for (int j = 0; j < 120; ++j) {
+            system(i, j) = std::sin(i + 2.0 * j) + (i == j ? 130.0 : 0.0);
+            rhs(i, j) = std::cos(3.0 * i - j);
+        }
+    SquareMat x = solveMixed(system, rhs, &residual);
+    CHECK(residual < 1e-14);
+    CHECK(productResidual(system, x, rhs) < 1e-13);
+
+    // Hilbert matrix: too ill-conditioned for float, solved again in double
+    SquareMat hilbert(8), identity(8);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j)
+            hilbert(i, j) = 1.0 / (i + j + 1);
+        identity(i, i) = 1.0;
+    }
+    SquareMat inverse = solveMixed(hilbert, identity, &residual);
+    CHECK(residual < 1e-14);
+    CHECK(std::abs(inverse(0, 0) - 64.0) < 1e-4);
+
+    SquareMat singular(3);
+    singular(0, 0) = 1.0;
+    singular(1, 1) = 1.0;
+    CHECK_THROWS_AS(solveMixed(singular, singular), std::invalid_argument);
+    CHECK_THROWS_AS(multiplyMixed(a, SquareMat(3)), std::invalid_argument);
+    CHECK_THROWS_AS(solveMixed(a, SquareMat(3)), std::invalid_argument);
+}
+
+/**
+ * Test case for the power operator's buffer reuse
+ * Every exponent must match repeated multiplication, and a huge exponent must take
+ * exactly three allocations (the two work buffers and the result)
+ */
+TEST_CASE("Allocation-free power") {
+    IntSquareMat a(6);
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            a(i, j) = (i * 5 + j * 3) % 4 == 0 ? 1 : 0;
+    a(0, 1) = 1;
+    IntSquareMat expected(6);
+    for (int i = 0; i < 6; ++i)
+        expected(i, i) = 1;
+    bool same = true;
+    for (int power = 0; power <= 20; ++power) {
+        same = same && sameElements(a ^ power, expected);
+        expected = naiveProduct(expected, a);
+    }
+    CHECK(same);
+
+    CountingResource counting;
+    {
+        SquareMat stochastic(50, &counting);
+        for (int i = 0; i < 50; ++i) {
+            stochastic(i, i) = 0.5;
+            stochastic(i, (i + 1) % 50) = 0.5;
+        }
+        const int before = counting.allocations;
+        SquareMat stepped = stochastic ^ 1000000;
+        CHECK(counting.allocations - before == 3);
+        CHECK(stepped.getResource() == &counting);
+        double rowSum = 0;
+        for (int j = 0; j < 50; ++j)
+            rowSum += stepped(7, j);
+        CHECK(rowSum == doctest::Approx(1.0));
+        CHECK(stepped(7, 3) == doctest::Approx(1.0 / 50));
+
+        SquareMat once = stochastic ^ 1;
+        CHECK(counting.allocations - before == 4);
+        CHECK(sameElements(once, stochastic));
+    }
+    CHECK(counting.live == 0);
+}
+
+/**
+ * Fibonacci number F(p) mod m by fast doubling, the reference for the modular power
+ */
+static std::int64_t fibonacciMod(std::int64_t p, std::int64_t m) {
+    using Wide = unsigned __int128;
+    std::uint64_t f = 0, g = 1; // F(k), F(k + 1) for the prefix of p's bits read so far
+    for (int bit = 62; bit >= 0; --bit) {
+        const std::uint64_t twice = (2 * static_cast<Wide>(g) + m - f) % m;
+        const std::uint64_t f2 = static_cast<Wide>(f) * twice % m;                                    // F(2k)
+        const std::uint64_t g2 = (static_cast<Wide>(f) * f + static_cast<Wide>(g) * g) % m;          // F(2k + 1)
+        f = f2;
+        g = g2;
+        if ((p >> bit) & 1) {
+            const std::uint64_t next = (static_cast<Wide>(f) + g) % m;
+            f = g;
+            g = next;
+        }
+    }
+    return static_cast<std::int64_t>(f);
+}
+
+/**
+ * Test case for the modular matrix power
+ * Huge exponents against fast-doubling Fibonacci for small and 61-bit moduli, small exponents
+ * against repeated multiplication, and a product large enough for the thread pool
+ */
+TEST_CASE("Modular matrix power") {
+    IntSquareMat fibonacci(2);
+    fibonacci(0, 0) = 1; fibonacci(0, 1) = 1;
+    fibonacci(1, 0) = 1;
+    const std::int64_t prime = 1000000007;
+    const std::int64_t mersenne = (std::int64_t(1) << 61) - 1;
+    for (std::int64_t power : {std::int64_t(1), std::int64_t(90), std::int64_t(1000000000000000000)}) {
+        CHECK(powMod(fibonacci, power, prime)(0, 1) == fibonacciMod(power, prime));
+        CHECK(powMod(fibonacci, power, mersenne)(0, 1) == fibonacciMod(power, mersenne));
+    }
+    CHECK(powMod(fibonacci, 90, mersenne)(0, 1) == 2880067194370816120 - mersenne); // F(90) exceeds 2^61 - 1
+
+    IntSquareMat a(5);
+    fillPattern(a, 3); // Includes negative elements
+    IntSquareMat expected(5);
+    for (int i = 0; i < 5; ++i)
+        expected(i, i) = 1;
+    bool same = true;
+    for (int power = 0; power <= 30; ++power) {
+        same = same && sameElements(powMod(a, power, 97), expected);
+        expected = naiveProduct(expected, a) % 97;
+        for (int i = 0; i < 5; ++i)
+            for (int j = 0; j < 5; ++j)
+                expected(i, j) = (expected(i, j) + 97) % 97;
+    }
+    CHECK(same);
+
+    const int n = 300;
+    const std::int64_t modulus = 1000003;
+    IntSquareMat big(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            big(i, j) = (i * 7919 + j * 104729) % modulus;
+    IntSquareMat cube = naiveProduct(naiveProduct(big, big) % 1000003, big) % 1000003;
+    CHECK(sameElements(powMod(big, 3, modulus), cube));
+
+    CHECK(sameElements(powMod(a, 12345, 1), IntSquareMat(5)));
+    CHECK(powMod(a, 0, 1)(0, 0) == 0);
+    CHECK_THROWS_AS(powMod(a, -1, 97), std::invalid_argument);
+    CHECK_THROWS_AS(powMod(a, 3, 0), std::invalid_argument);
+}
+
+/**
+ * Test case for the linear-recurrence fast path
+ * Terms must match direct iteration, and companion matrices must give the same elements
+ * as operator^ and powMod for every position
+ */
+TEST_CASE("Linear recurrences") {
+    const std::vector<std::int64_t> fibonacciStep{1, 1}, fibonacciStart{0, 1};
+    CHECK(recurrenceTerm(fibonacciStep, fibonacciStart, 0) == 0);
+    CHECK(recurrenceTerm(fibonacciStep, fibonacciStart, 1) == 1);
+    CHECK(recurrenceTerm(fibonacciStep, fibonacciStart, 90) == 2880067194370816120);
+    const std::int64_t prime = 1000000007;
+    CHECK(recurrenceTermMod(fibonacciStep, fibonacciStart, 1000000000000000000, prime) ==
+          fibonacciMod(1000000000000000000, prime));
+
+    // a(n) = 0.5 a(n-1) - 0.25 a(n-2) + 2 a(n-3), against direct iteration
+    const std::vector<double> step{0.5, -0.25, 2.0}, start{1.0, -1.0, 3.0};
+    std::vector<double> terms(start);
+    for (int n = 3; n <= 40; ++n)
+        terms.push_back(0.5 * terms[n - 1] - 0.25 * terms[n - 2] + 2.0 * terms[n - 3]);
+    bool close = true;
+    for (int n = 0; n <= 40; ++n)
+        close = close && std::abs(recurrenceTerm(step, start, n) - terms[n]) <= 1e-12 * std::abs(terms[n]);
+    CHECK(close);
+    CHECK(recurrenceTerm(std::vector<double>{3.0}, std::vector<double>{2.0}, 5) == 486.0);
+
+    IntSquareMat companion(5);
+    const std::int64_t coefficients[] = {1, -2, 0, 3, 1};
+    for (int j = 0; j < 5; ++j)
+        companion(0, j) = coefficients[j];
+    for (int i = 1; i < 5; ++i)
+        companion(i, i - 1) = 1;
+    std::vector<std::int64_t> found;
+    REQUIRE(companionCoefficients(companion, found));
+    CHECK(found == std::vector<std::int64_t>(coefficients, coefficients + 5));
+
+    bool same = true;
+    for (int power : {0, 1, 4, 5, 13}) {
+        const IntSquareMat raised = companion ^ power;
+        const IntSquareMat reduced = powMod(companion, 123456789012345 + power, 998244353);
+        for (int i = 0; i < 5; ++i)
+            for (int j = 0; j < 5; ++j)
+                same = same && powerElement(companion, power, i, j) == raised(i, j) &&
+                       powModElement(companion, 123456789012345 + power, 998244353, i, j) == reduced(i, j);
+    }
+    CHECK(same);
+
+    // Not in companion form: operator^ and powMod answer instead
+    IntSquareMat other(companion);
+    other(2, 3) = 1;
+    CHECK_FALSE(companionCoefficients(other, found));
+    CHECK(powerElement(other, 7, 4, 0) == (other ^ 7)(4, 0));
+    CHECK(powModElement(other, 1000000, 97, 1, 2) == powMod(other, 1000000, 97)(1, 2));
+
+    CHECK_THROWS_AS(recurrenceTerm(std::vector<double>{}, std::vector<double>{}, 3), std::invalid_argument);
+    CHECK_THROWS_AS(recurrenceTerm(step, std::vector<double>{1.0}, 3), std::invalid_argument);
+    CHECK_THROWS_AS(recurrenceTerm(step, start, -1), std::invalid_argument);
+    CHECK_THROWS_AS(recurrenceTermMod(fibonacciStep, fibonacciStart, 5, 0), std::invalid_argument);
+    CHECK_THROWS_AS(powerElement(companion, 2, 5, 0), std::out_of_range);
+    CHECK_THROWS_AS(powModElement(companion, -2, 7, 0, 0), std::invalid_argument);
+}
+
+/**
+ * Test case for negative powers and the LU inverse
+ * A^-k must undo A^k, singular matrices must be rejected from the pivots, and integer
+ * matrices, which have no inverse of their own type, must keep rejecting negative powers
+ */
+TEST_CASE("Negative powers") {
+    SquareMat a(3);
+    a[0][0] = 0; a[0][1] = 2; a[0][2] = 1; // Zero in the corner, so the first step must pivot
+    a[1][0] = 1; a[1][1] = 1; a[1][2] = 0;
+    a[2][0] = 3; a[2][1] = 0; a[2][2] = 1;
+    const SquareMat inv = a.inverse();
+    const SquareMat product = a * inv;
+    bool identity = true;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            identity = identity && std::abs(product(i, j) - (i == j ? 1.0 : 0.0)) < 1e-14;
+    CHECK(identity);
+    CHECK(sameElements(a ^ -1, inv));
+
+    SquareMat b(40);
+    for (int i = 0; i < 40; ++i)
+        for (int j = 0; j < 40; ++j)
+            b(i, j) = std::sin(i * 3.0 + j) + (i == j ? 8.0 : 0.0);
+    const SquareMat undone = (b ^ 5) * (b ^ -5);
+    bool close = true;
+    for (int i = 0; i < 40; ++i)
+        for (int j = 0; j < 40; ++j)
+            close = close && std::abs(undone(i, j) - (i == j ? 1.0 : 0.0)) < 1e-9;
+    CHECK(close);
+
+    ComplexSquareMat c(2);
+    c(0, 0) = std::complex<double>(0, 1);
+    c(1, 1) = 2.0;
+    const ComplexSquareMat cInverse = c ^ -2;
+    CHECK(std::abs(cInverse(0, 0) - std::complex<double>(-1, 0)) < 1e-15);
+    CHECK(std::abs(cInverse(1, 1) - 0.25) < 1e-15);
+
+    SquareMat singular(3);
+    singular[0][0] = 1; singular[0][1] = 2; singular[0][2] = 3;
+    singular[1][0] = 2; singular[1][1] = 4; singular[1][2] = 6;
+    singular[2][0] = 1; singular[2][1] = 0; singular[2][2] = 1;
+    CHECK_THROWS_AS(singular ^ -3, std::invalid_argument);
+    CHECK_THROWS_AS(singular.inverse(), std::invalid_argument);
+
+    // Singular, but elimination leaves rounding residue instead of an exact zero pivot
+    SquareMat rounded(3), counting(5);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            rounded(i, j) = i * 3 + j + 1;
+    for (int i = 0; i < 5; ++i)
+        for (int j = 0; j < 5; ++j)
+            counting(i, j) = i * 5 + j + 1;
+    CHECK_THROWS_AS(rounded ^ -1, std::invalid_argument);
+    CHECK_THROWS_AS(counting.inverse(), std::invalid_argument);
+    CHECK_THROWS_AS(IntSquareMat(3) ^ -1, std::invalid_argument);
+}
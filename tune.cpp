@@ -0,0 +1,101 @@
+// Author: realyoavperetz@gmail.com
+
+#include "SquareMatrix.hpp"
+#include "Gemm.hpp"
+#include "SimdKernels.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace operators;
+
+// Default size of the benchmarked products: large enough to exercise every blocking level
+static constexpr int DEFAULT_TUNE_SIZE = 1024;
+
+// Timed runs per candidate; the fastest one counts
+static constexpr int REPEATS = 3;
+
+// Candidate sizes, tried one parameter at a time starting from the built-in blocking
+static const int KC_CANDIDATES[] = {128, 192, 256, 384, 512, 768};
+static const int MC_CANDIDATES[] = {48, 72, 96, 144, 192, 288};
+static const int NC_CANDIDATES[] = {1024, 2048, 4096, 8192};
+
+// Fastest of REPEATS products a * b with the given blocking, in seconds
+template <typename T>
+static double timeProduct(const BasicSquareMat<T>& a, const BasicSquareMat<T>& b, BasicSquareMat<T>& c,
+                          kernels::GemmBlocking blocking) {
+    kernels::setGemmBlocking<T>(blocking);
+    double best = 0;
+    for (int run = 0; run < REPEATS; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        gemm(T(1), a, b, T(0), c);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+// Replaces one field of best by each candidate in turn and keeps the fastest
+template <typename T, int N>
+static void tuneField(const BasicSquareMat<T>& a, const BasicSquareMat<T>& b, BasicSquareMat<T>& c,
+                      kernels::GemmBlocking& best, double& bestTime, int kernels::GemmBlocking::*field,
+                      const int (&candidates)[N]) {
+    for (int candidate : candidates) {
+        kernels::GemmBlocking trial = best;
+        trial.*field = candidate;
+        const double time = timeProduct(a, b, c, trial);
+        if (time < bestTime) {
+            bestTime = time;
+            best = trial;
+        }
+    }
+}
+
+// Tunes the blocking for elements of type T on the active instruction set and keeps the result
+template <typename T>
+static void tune(const char* typeName, int n) {
+    BasicSquareMat<T> a(n), b(n), c(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            a(i, j) = static_cast<T>((i * 31 + j * 17) % 11 - 5);
+            b(i, j) = static_cast<T>((i * 13 + j * 29) % 7 - 3);
+        }
+
+    kernels::setGemmBlocking<T>({0, 0, 0});
+    kernels::GemmBlocking best = kernels::gemmBlocking<T>();
+    const double builtInTime = timeProduct(a, b, c, best);
+    double bestTime = builtInTime;
+    tuneField(a, b, c, best, bestTime, &kernels::GemmBlocking::kc, KC_CANDIDATES);
+    tuneField(a, b, c, best, bestTime, &kernels::GemmBlocking::mc, MC_CANDIDATES);
+    tuneField(a, b, c, best, bestTime, &kernels::GemmBlocking::nc, NC_CANDIDATES);
+    kernels::setGemmBlocking<T>(best);
+
+    const double flops = 2.0 * n * n * n;
+    std::cout << typeName << ": mc " << best.mc << ", kc " << best.kc << ", nc " << best.nc << " -> "
+              << flops / bestTime * 1e-9 << " GFLOP/s (built-in " << flops / builtInTime * 1e-9 << ")" << std::endl;
+}
+
+// Usage: Tune [profile] [size]
+int main(int argc, char* argv[]) {
+    const char* profile = argc > 1 ? argv[1] : "gemm.tuning";
+    const int n = argc > 2 ? std::atoi(argv[2]) : DEFAULT_TUNE_SIZE;
+    if (n <= 0) {
+        std::cerr << "Size must be positive" << std::endl;
+        return 1;
+    }
+
+    // Time the blocked kernel itself, not the Strassen recursion above it
+    kernels::setStrassenCrossover(0);
+    std::cout << "Tuning GEMM blocking for " << kernels::isaName(kernels::activeIsa()) << " at size " << n
+              << "..." << std::endl;
+    tune<double>("double", n);
+    tune<float>("float", n);
+
+    if (!kernels::saveTuningProfile(profile)) {
+        std::cerr << "Cannot write " << profile << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << profile << std::endl;
+    return 0;
+}